@@ -0,0 +1,71 @@
+//
+//  POSLens+Internal.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLens.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+//
+// Private interfaces of the lenses for the library components which
+// coordinate updates of several lenses. Don't use them in applications.
+//
+
+@protocol POSValueStore;
+@class POSLensValueInterner;
+@class POSLensUpdateScheduler;
+
+typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable oldValue, NSError **error);
+
+@class POSRootLens;
+
+@interface POSLensValueUpdate ()
+
+- (instancetype)initWithOldValue:(nullable POSLensValue *)oldValue
+                     actualValue:(nullable POSLensValue *)actualValue;
+
+@end
+
+@interface POSMutableLens (Internal)
+
+/// The lens at the top of the hierarchy which owns the value and its store.
+@property (nonatomic, readonly) POSRootLens *pos_rootLens;
+
+/// Extracts the value of the lens from the specified value of its root lens.
+- (nullable id)pos_valueInRootValue:(nullable POSLensValue *)rootValue;
+
+/// Converts the block which updates the value of the lens into the block which updates the value of its root lens.
+- (POSLensUpdateBlock)pos_rootUpdateBlockWithBlock:(POSLensUpdateBlock)block;
+
+@end
+
+@interface POSRootLens : POSMutableLens
+
+@property (nonatomic, readonly, nullable) id<POSLogger> logger;
+@property (nonatomic, readonly) dispatch_queue_t syncQueue;
+@property (nonatomic, readonly) dispatch_queue_t persistenceQueue;
+@property (nonatomic, readonly) POSLensUpdateScheduler *scheduler;
+@property (nonatomic, readonly) id<POSValueStore> store;
+@property (nonatomic, readonly, nullable) POSLensValueInterner *interner;
+@property (nonatomic, nullable) POSLensValue *currentValue;
+@property (nonatomic, readonly) RACSubject<POSLensValueUpdate<POSLensValue *> *> *updatesSubject;
+
+/// Returns the canonical instance of the value if the lens has the interner.
+- (nullable POSLensValue *)canonicalValue:(nullable POSLensValue *)value;
+
+/// Loads value from the store after all pending saves.
+- (nullable POSLensValue *)loadPersistedValue:(NSError **)error;
+
+/// Saves value into the store after all pending saves.
+- (BOOL)persistValue:(nullable POSLensValue *)value error:(NSError **)error;
+
+/// Replaces the current value without blocking readers for more than an assignment.
+- (void)commitValue:(nullable POSLensValue *)value;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -7,6 +7,7 @@
 //
 
 #import "POSLensValue.h"
+#import "POSLensWaitMetrics.h"
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wstrict-prototypes"
@@ -239,7 +240,8 @@ POS_INIT_UNAVAILABLE
 ///             the thread-safe updateBlock.
 ///
 /// @discussion Update block provides current value as an input parameter for exclusive modification.
-///             Other value clients cannot read and modify it until block execution is in progress.
+///             Other value clients cannot modify it until block execution is in progress, and they read
+///             the previous value until the update is committed.
 ///             This statement is true even if those clients use independent instances of the POSLens
 ///             objects to manage the underlying value at the same path in the object's graph.
 ///
@@ -256,7 +258,8 @@ POS_INIT_UNAVAILABLE
 ///             the thread-safe updateBlock.
 ///
 /// @discussion Update block provides current value as an input parameter for exclusive modification.
-///             Other value clients cannot read and modify it until block execution is in progress.
+///             Other value clients cannot modify it until block execution is in progress, and they read
+///             the previous value until the update is committed.
 ///             This statement is true even if those clients use independent instances of the POSLens
 ///             objects to manage the underlying value at the same path in the object's graph.
 ///
@@ -276,7 +279,8 @@ POS_INIT_UNAVAILABLE
 ///             the thread-safe updateBlock.
 ///
 /// @discussion Update block provides current value as an input parameter for exclusive modification.
-///             Other value clients cannot read and modify it until block execution is in progress.
+///             Other value clients cannot modify it until block execution is in progress, and they read
+///             the previous value until the update is committed.
 ///             This statement is true even if those clients use independent instances of the POSLens
 ///             objects to manage the underlying value at the same path in the object's graph.
 ///
@@ -294,7 +298,8 @@ POS_INIT_UNAVAILABLE
 ///             the thread-safe updateBlock.
 ///
 /// @discussion Update block provides current value as an input parameter for exclusive modification.
-///             Other value clients cannot read and modify it until block execution is in progress.
+///             Other value clients cannot modify it until block execution is in progress, and they read
+///             the previous value until the update is committed.
 ///             This statement is true even if those clients use independent instances of the POSLens
 ///             objects to manage the underlying value at the same path in the object's graph.
 ///
@@ -315,7 +320,8 @@ POS_INIT_UNAVAILABLE
 ///             the thread-safe updateBlock.
 ///
 /// @discussion Update block provides current value as an input parameter for exclusive modification.
-///             Other value clients cannot read and modify it until block execution is in progress.
+///             Other value clients cannot modify it until block execution is in progress, and they read
+///             the previous value until the update is committed.
 ///             This statement is true even if those clients use independent instances of the POSLens
 ///             objects to manage the underlying value at the same path in the object's graph.
 ///
@@ -333,7 +339,8 @@ POS_INIT_UNAVAILABLE
 ///             the thread-safe updateBlock.
 ///
 /// @discussion Update block provides current value as an input parameter for exclusive modification.
-///             Other value clients cannot read and modify it until block execution is in progress.
+///             Other value clients cannot modify it until block execution is in progress, and they read
+///             the previous value until the update is committed.
 ///             This statement is true even if those clients use independent instances of the POSLens
 ///             objects to manage the underlying value at the same path in the object's graph.
 ///
@@ -370,11 +377,29 @@ POS_INIT_UNAVAILABLE
 ///
 - (void)removeValueAnyway;
 
+///
+/// @brief      Statistics of the time which updates of the root value spent waiting for their turn.
+///
+/// @discussion Updates are prioritized according to the QoS class of the updating thread. Urgent updates
+///             go ahead of the queued less urgent ones, and readers never wait for the value store.
+///             Background updates commit the value in memory and save it after they release their turn,
+///             so an urgent update doesn't wait for the background save to get its turn. Background force
+///             updates don't wait for the save at all, and the queued ones are skipped by the newer saves.
+///
+/// @remarks    Other background updates wait for their save and return its error, but the value stays
+///             in memory and is persisted by the next successful save. Urgent and default updates still
+///             save the value while they hold their turn, and their saves are queued after the saves
+///             which are already in progress.
+///
+- (POSLensWaitMetrics *)waitMetricsForPriority:(POSLensUpdatePriority)priority;
+
 @end
 
 #pragma mark -
 
 @protocol POSValueStore;
+@protocol POSKeyPathValueStore;
+@class POSLensValueInterner;
 
 ///
 /// Lens factory methods. They contain minimal parameters set for persisting stores.
@@ -407,6 +432,41 @@ POS_INIT_UNAVAILABLE
                                        logger:(nullable id<POSLogger>)logger
                                         error:(NSError **)error;
 
+///
+/// Creates lens which canonicalizes its value on each commit.
+///
+/// @discussion Equal subtrees of the value share a single instance, which reduces memory consumption
+///             for graphs with many similar records and lets equality checks stop on identical objects.
+///             Lenses may share the interner to deduplicate values between each other.
+///
+/// @param value    The default value for the case when provided store doesn't contain any value yet.
+/// @param store    A prebuilt or user-defined storage service to persist value.
+/// @param interner Table of canonical values or nil to keep values as is.
+/// @param error    An error which occurred during the initial value loading from the storage service.
+///
++ (nullable instancetype)lensWithDefaultValue:(nullable POSLensValue *)value
+                                        store:(id<POSValueStore>)store
+                                     interner:(nullable POSLensValueInterner *)interner
+                                       logger:(nullable id<POSLogger>)logger
+                                        error:(NSError **)error;
+
+///
+/// Creates lens for the part of the value in the store which loads and saves parts independently.
+///
+/// @discussion The lens loads only the subtree at the keypath and saves it without rewriting
+///             the rest of the value. Several lenses may target different keypaths of a single store.
+///
+/// @param value   The default value for the case when the store doesn't contain a value at the keypath.
+/// @param store   A storage service which persists parts of the value, for example POSSQLiteValueStore.
+/// @param keyPath Dot separated keys of nested dictionaries. Empty string means the root value.
+/// @param error   An error which occurred during the initial value loading from the storage service.
+///
++ (nullable instancetype)lensWithDefaultValue:(nullable POSLensValue *)value
+                                        store:(id<POSKeyPathValueStore>)store
+                                      keyPath:(NSString *)keyPath
+                                       logger:(nullable id<POSLogger>)logger
+                                        error:(NSError **)error;
+
 ///
 /// Creates lens with file-based POSFileValueStore.
 ///
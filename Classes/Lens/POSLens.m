@@ -7,6 +7,9 @@
 //
 
 #import "POSLens.h"
+#import "POSLens+Internal.h"
+#import "POSLensValueInterner.h"
+#import "POSLensUpdateScheduler.h"
 
 #import "POSEphemeralValueStore.h"
 #import "POSFileValueStore.h"
@@ -14,11 +17,10 @@
 #import "POSUserDefaultsValueStore.h"
 
 #import "NSError+POSLens.h"
+#include <stdatomic.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable oldValue, NSError **error);
-
 @implementation POSLensValueUpdate
 
 - (instancetype)initWithOldValue:(nullable POSLensValue *)oldValue
@@ -213,6 +215,10 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
         error:error];
 }
 
+- (POSLensWaitMetrics *)waitMetricsForPriority:(POSLensUpdatePriority)priority {
+    return [self.pos_rootLens waitMetricsForPriority:priority];
+}
+
 - (void)removeValueAnyway {
     [self
         updateValueWithBlock:^POSLensValue * _Nullable(POSLensValue * _Nullable currentValue, NSError **error) {
@@ -272,9 +278,33 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
 - (BOOL)updateValueWithBlock:(POSLensUpdateBlock)updateBlock
            ignoreStoreErrors:(BOOL)ignoreStoreErrors
                        error:(NSError **)error {
+    return [_parent
+            updateValueWithBlock:[self p_parentUpdateBlockWithBlock:updateBlock]
+            ignoreStoreErrors:ignoreStoreErrors
+            error:error];
+}
+
+#pragma mark - POSMutableLens (Internal)
+
+- (POSRootLens *)pos_rootLens {
+    return _parent.pos_rootLens;
+}
+
+- (nullable id)pos_valueInRootValue:(nullable POSLensValue *)rootValue {
+    id value = [[_parent pos_valueInRootValue:rootValue] pos_valueForKey:_key];
+    return value ?: self.defaultValue;
+}
+
+- (POSLensUpdateBlock)pos_rootUpdateBlockWithBlock:(POSLensUpdateBlock)block {
+    return [_parent pos_rootUpdateBlockWithBlock:[self p_parentUpdateBlockWithBlock:block]];
+}
+
+#pragma mark - Private
+
+- (POSLensUpdateBlock)p_parentUpdateBlockWithBlock:(POSLensUpdateBlock)updateBlock {
     POS_CHECK(updateBlock);
     @weakify(self);
-    __auto_type parentUpdateBlock = ^POSLensValue * _Nullable(POSLensValue * _Nullable parentValue, NSError **error) {
+    return ^POSLensValue * _Nullable(POSLensValue * _Nullable parentValue, NSError **error) {
         @strongify(self); // self is never nil because of synchronous nature of updateBlock.
         id currentValue = [parentValue pos_valueForKey:self->_key];
         id updatedValue = updateBlock(currentValue, error);
@@ -292,35 +322,33 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
                                @"Parent of property %@ has neither value or default value.", self.keyPath]);
         return parentValue;
     };
-    return [_parent updateValueWithBlock:parentUpdateBlock ignoreStoreErrors:ignoreStoreErrors error:error];
 }
 
 @end
 
 #pragma mark -
 
-@interface POSRootLens : POSMutableLens
-
-@property (nonatomic, readonly, nullable) id<POSLogger> logger;
-@property (nonatomic, readonly) dispatch_queue_t syncQueue;
-@property (nonatomic, readonly) id<POSValueStore> store;
-@property (nonatomic, nullable) POSLensValue *currentValue;
-@property (nonatomic, readonly) RACSubject<POSLensValueUpdate<POSLensValue *> *> *updatesSubject;
-
-@end
-
-@implementation POSRootLens
+@implementation POSRootLens {
+    atomic_uint_fast64_t _saveGeneration;
+}
 
 - (instancetype)initWithDefaultValue:(nullable POSLensValue *)defaultValue
                         currentValue:(nullable POSLensValue *)currentValue
                                store:(id<POSValueStore>)store
+                            interner:(nullable POSLensValueInterner *)interner
                               logger:(nullable id<POSLogger>)logger {
     POS_CHECK(store);
     if (self = [super initWithDefaultValue:defaultValue]) {
         _logger = logger;
         _syncQueue = dispatch_queue_create("com.github.pavelosipov.POSLens", DISPATCH_QUEUE_CONCURRENT);
+        _persistenceQueue = dispatch_queue_create("com.github.pavelosipov.POSLens.persistence",
+                                                  dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL,
+                                                                                          QOS_CLASS_UTILITY,
+                                                                                          0));
+        _scheduler = [POSLensUpdateScheduler new];
         _store = store;
-        _currentValue = currentValue;
+        _interner = interner;
+        _currentValue = [self canonicalValue:currentValue];
         _updatesSubject = [RACSubject subject];
     }
     return self;
@@ -351,7 +379,7 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
 - (BOOL)resetValue:(NSError **)error {
     __auto_type saveBlock = ^POSLensValue * _Nullable(POSLensValue * _Nullable value, BOOL *flush, NSError **error) {
         *flush = NO;
-        return [self->_store loadValue:error];
+        return [self loadPersistedValue:error];
     };
     return [self updateCurrentValueWithBlock:saveBlock ignoreStoreErrors:NO error:error];
 }
@@ -365,6 +393,55 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
     return [self updateCurrentValueWithBlock:updateBlock ignoreStoreErrors:ignoreStoreErrors error:error];
 }
 
+#pragma mark - POSMutableLens (Internal)
+
+- (POSRootLens *)pos_rootLens {
+    return self;
+}
+
+- (nullable id)pos_valueInRootValue:(nullable POSLensValue *)rootValue {
+    return rootValue ?: self.defaultValue;
+}
+
+- (POSLensUpdateBlock)pos_rootUpdateBlockWithBlock:(POSLensUpdateBlock)block {
+    return block;
+}
+
+- (nullable POSLensValue *)canonicalValue:(nullable POSLensValue *)value {
+    return _interner ? [_interner internValue:value] : value;
+}
+
+- (nullable POSLensValue *)loadPersistedValue:(NSError **)error {
+    __block POSLensValue *value = nil;
+    __block NSError *loadError = nil;
+    dispatch_sync(_persistenceQueue, ^{
+        value = [self->_store loadValue:&loadError];
+    });
+    POSAssignError(error, loadError);
+    return value;
+}
+
+- (BOOL)persistValue:(nullable POSLensValue *)value error:(NSError **)error {
+    __block BOOL saved = NO;
+    __block NSError *saveError = nil;
+    // Queued background force saves are superseded by that one.
+    atomic_fetch_add(&_saveGeneration, 1);
+    // Serial queue keeps saves in the commit order even if some of them are still in the background.
+    dispatch_sync(_persistenceQueue, ^{
+        saved = [self->_store saveValue:value error:&saveError];
+    });
+    if (!saved) {
+        POSAssignError(error, saveError);
+    }
+    return saved;
+}
+
+- (void)commitValue:(nullable POSLensValue *)value {
+    dispatch_barrier_sync(_syncQueue, ^{
+        self.currentValue = value;
+    });
+}
+
 - (BOOL)updateCurrentValueWithBlock:(POSLensValue *  _Nullable (^)(POSLensValue * _Nullable,
                                                                    BOOL *flush,
                                                                    NSError **error))updateBlock
@@ -376,18 +453,40 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
     __block NSError *updateError = nil;
     __block POSLensValue *updatingValue;
     __block POSLensValue *updatedValue;
-    dispatch_barrier_sync(_syncQueue, ^{
+    __block dispatch_semaphore_t backgroundSaveSemaphore = nil;
+    __block NSError *backgroundSaveError = nil;
+    POSLensUpdatePriority priority = POSLensUpdatePriorityOfCurrentThread();
+    [_scheduler performWithPriority:priority block:^{
         updatingValue = self->_currentValue;
         updatedValue = updateBlock(updatingValue, &flush, &updateError);
+        if (updateError == nil) {
+            updatedValue = [self canonicalValue:updatedValue];
+        }
         updated = (updateError == nil && updatedValue != updatingValue && ![updatedValue isEqual:updatingValue]);
-        if (updated) {
-            BOOL saved = flush ? [self->_store saveValue:updatedValue error:&updateError] : YES;
-            updated = saved || ignoreStoreErrors;
+        if (updated && flush) {
+            if (priority == POSLensUpdatePriorityBackground && ignoreStoreErrors) {
+                [self p_persistValueInBackground:updatedValue completion:nil];
+            } else if (priority == POSLensUpdatePriorityBackground) {
+                // Background updates don't hold their turn during the save, so urgent ones may go ahead.
+                dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+                backgroundSaveSemaphore = semaphore;
+                [self p_persistValueInBackground:updatedValue completion:^(NSError * _Nullable saveError) {
+                    backgroundSaveError = saveError;
+                    dispatch_semaphore_signal(semaphore);
+                }];
+            } else {
+                BOOL saved = [self persistValue:updatedValue error:&updateError];
+                updated = saved || ignoreStoreErrors;
+            }
         }
         if (updated) {
-            self.currentValue = updatedValue;
+            [self commitValue:updatedValue];
         }
-    });
+    }];
+    if (backgroundSaveSemaphore) {
+        dispatch_semaphore_wait(backgroundSaveSemaphore, DISPATCH_TIME_FOREVER);
+        updateError = backgroundSaveError;
+    }
     if (error) {
         POSAssignError(error, updateError);
     } else if (updateError) {
@@ -401,6 +500,81 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
     return updateError == nil;
 }
 
+- (POSLensWaitMetrics *)waitMetricsForPriority:(POSLensUpdatePriority)priority {
+    return [_scheduler waitMetricsForPriority:priority];
+}
+
+#pragma mark - Private
+
+///
+/// Saves the value after all pending saves without blocking the caller.
+/// @param completion Receives the error of the save. Saves without completion are skipped
+///                   when newer saves are queued after them.
+///
+- (void)p_persistValueInBackground:(nullable POSLensValue *)value
+                        completion:(nullable void (^)(NSError * _Nullable error))completion {
+    uint64_t generation = atomic_fetch_add(&_saveGeneration, 1) + 1;
+    dispatch_async(_persistenceQueue, ^{
+        if (!completion && atomic_load(&self->_saveGeneration) != generation) {
+            return;
+        }
+        NSError *saveError = nil;
+        BOOL saved = [self->_store saveValue:value error:&saveError];
+        if (completion) {
+            completion(saved ? nil : saveError);
+        } else if (!saved) {
+            NSString *valueName = NSStringFromClass([(NSObject *)value class]);
+            [self->_logger logError:@"Lens<%@>: Failed to save value in background: %@", valueName, saveError];
+        }
+    });
+}
+
+@end
+
+#pragma mark -
+
+/// Presents the part of the key path store as the whole value store.
+@interface POSKeyPathStoreAdapter : NSObject <POSValueStore>
+
+@property (nonatomic, readonly) id<POSKeyPathValueStore> store;
+@property (nonatomic, readonly) NSString *keyPath;
+
+- (instancetype)initWithStore:(id<POSKeyPathValueStore>)store keyPath:(NSString *)keyPath NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+@implementation POSKeyPathStoreAdapter
+
+- (instancetype)initWithStore:(id<POSKeyPathValueStore>)store keyPath:(NSString *)keyPath {
+    POS_CHECK(store);
+    POS_CHECK(keyPath);
+    if (self = [super init]) {
+        _store = store;
+        _keyPath = [keyPath copy];
+    }
+    return self;
+}
+
+- (BOOL)saveValue:(nullable POSLensValue *)value error:(NSError **)error {
+    return [_store saveValue:value atKeyPath:_keyPath error:error];
+}
+
+- (nullable POSLensValue *)loadValue:(NSError **)error {
+    NSError *loadError = nil;
+    id value = [_store loadValueAtKeyPath:_keyPath error:&loadError];
+    if (value != nil && ![value conformsToProtocol:@protocol(NSCopying)]) {
+        loadError = [NSError pos_systemErrorWithFormat:@"Loaded value %@ doesn't conform to NSCopying.", value];
+        value = nil;
+    }
+    POSAssignError(error, loadError);
+    return value;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@ keyPath='%@' store=%@>", self.class, _keyPath, _store];
+}
+
 @end
 
 #pragma mark -
@@ -419,6 +593,14 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
                                         store:(id<POSValueStore>)store
                                        logger:(nullable id<POSLogger>)logger
                                         error:(NSError **)error {
+    return [self lensWithDefaultValue:value store:store interner:nil logger:logger error:error];
+}
+
++ (nullable instancetype)lensWithDefaultValue:(nullable POSLensValue *)value
+                                        store:(id<POSValueStore>)store
+                                     interner:(nullable POSLensValueInterner *)interner
+                                       logger:(nullable id<POSLogger>)logger
+                                        error:(NSError **)error {
     NSError *loadError;
     POSLensValue *currentValue = [store loadValue:&loadError];
     if (loadError != nil) {
@@ -426,7 +608,24 @@ typedef POSLensValue * _Nullable(^POSLensUpdateBlock)(POSLensValue * _Nullable o
         POSAssignError(error, loadError);
         return nil;
     }
-    return [[POSRootLens alloc] initWithDefaultValue:value currentValue:currentValue store:store logger:logger];
+    return [[POSRootLens alloc]
+            initWithDefaultValue:value
+            currentValue:currentValue
+            store:store
+            interner:interner
+            logger:logger];
+}
+
++ (nullable instancetype)lensWithDefaultValue:(nullable POSLensValue *)value
+                                        store:(id<POSKeyPathValueStore>)store
+                                      keyPath:(NSString *)keyPath
+                                       logger:(nullable id<POSLogger>)logger
+                                        error:(NSError **)error {
+    return [self
+            lensWithDefaultValue:value
+            store:[[POSKeyPathStoreAdapter alloc] initWithStore:store keyPath:keyPath]
+            logger:logger
+            error:error];
 }
 
 + (nullable instancetype)lensWithDefaultValue:(nullable POSLensValue *)value
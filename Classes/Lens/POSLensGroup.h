@@ -0,0 +1,124 @@
+//
+//  POSLensGroup.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLens.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///
+/// Accumulates updates of the lenses inside POSLensGroup update block.
+///
+@interface POSLensTransaction : NSObject
+
+///
+/// @brief      The value of the lens including updates which were made in the transaction.
+///
+/// @remarks    Use that method instead of the value property of the lens inside update block,
+///             because the value property returns the last committed value until the end of the transaction.
+///             Readers are never blocked by the transaction, while other updates of the group's root lenses
+///             wait in their schedulers until it finishes.
+///
+- (nullable id)valueForLens:(POSLens *)lens;
+
+///
+/// @brief      Replaces the value of the lens.
+///
+/// @discussion The method returns NO and `error` out parameter if there are neither parent object
+///             or the default value for it.
+///
+- (BOOL)updateLens:(POSMutableLens *)lens value:(nullable POSLensValue *)value error:(NSError **)error;
+
+///
+/// @brief      Replaces the value of the lens with a new instance created by the updateBlock.
+///
+/// @discussion The method returns NO and `error` out parameter in the following cases:
+///             (a) update block returned an error,
+///             (b) there are neither parent object or the default value for it.
+///
+- (BOOL)updateLens:(POSMutableLens *)lens
+         withBlock:(id _Nullable (^)(id _Nullable oldValue, NSError **error))updateBlock
+             error:(NSError **)error;
+
+POS_INIT_UNAVAILABLE
+
+@end
+
+#pragma mark -
+
+///
+/// Durable record of the group's commit which is kept until all new values are saved into their stores.
+///
+/// @discussion The journal wraps stores of the group's lenses. The wrapped store replays its value from
+///             the journal before loading it, so the lens which is created after the application was terminated
+///             in the middle of the commit starts with the committed value even if the group isn't created yet.
+///             That requires values to conform to NSCoding protocol.
+///
+@interface POSLensGroupJournal : NSObject
+
+/// @param path Path to the journal file.
+- (instancetype)initWithPath:(NSString *)path;
+
+///
+/// @brief      Wraps the store of the group's lens.
+/// @param store      The store which is passed to the lens.
+/// @param identifier The key of the store's values in the journal. It should be unique within the journal and
+///                   the same across application launches.
+///
+- (id<POSValueStore>)storeWithStore:(id<POSValueStore>)store identifier:(NSString *)identifier;
+
+POS_INIT_UNAVAILABLE
+
+@end
+
+#pragma mark -
+
+///
+/// Unit of work for updating several root lenses atomically.
+///
+/// @discussion The group locks root lenses in a deterministic order, so concurrent groups with
+///             overlapping lenses never deadlock. All updates of the transaction are applied in memory,
+///             then persisted in one commit, and only after that lenses emit notifications about new values.
+///
+///             When the group has a journal, it writes all new values into the journal file with a single
+///             fsync before saving them into the stores of lenses and removes them afterwards. Without
+///             the journal the group rolls back already saved values if some store failed to save its value.
+///
+/// @remarks    The group provides atomicity, not fewer writes. Every changed lens is still saved by its own
+///             store, so the commit of N lenses costs N store writes plus writing and removing the journal
+///             when the group has one. Use the group without the journal if the crash recovery isn't worth it.
+///
+@interface POSLensGroup : NSObject
+
+///
+/// @brief      Creates group for the specified lenses.
+///
+/// @param lenses  Root or property lenses.
+/// @param journal The journal which wrapped stores of all root lenses or nil if the group doesn't need
+///                crash recovery.
+///
++ (instancetype)groupWithLenses:(NSArray<POSMutableLens *> *)lenses
+                        journal:(nullable POSLensGroupJournal *)journal
+                         logger:(nullable id<POSLogger>)logger;
+
+///
+/// @brief      Atomically updates values of the group's lenses.
+///
+/// @discussion The block may update only lenses which belong to the roots of the group's lenses.
+///             Nothing is changed if the block returns NO or some of the stores fails to save its value.
+///             The method returns NO and `error` out parameter in these cases.
+///
+/// @returns    YES if all updated values were successfully persisted in their stores.
+///
+- (BOOL)updateWithBlock:(BOOL (^)(POSLensTransaction *transaction, NSError **error))updateBlock
+                  error:(NSError **)error;
+
+POS_INIT_UNAVAILABLE
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,416 @@
+//
+//  POSLensGroup.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensGroup.h"
+#import "POSLens+Internal.h"
+#import "POSLensUpdateScheduler.h"
+#import "POSValueStore.h"
+#import "POSFileIO.h"
+#import "POSKeyedArchiving.h"
+#import "NSError+POSLens.h"
+#include <unistd.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface POSLensTransaction ()
+@property (nonatomic, readonly) NSMapTable<POSRootLens *, id> *values;
+@end
+
+@implementation POSLensTransaction
+
+- (instancetype)initWithRoots:(NSArray<POSRootLens *> *)roots {
+    if (self = [super init]) {
+        _values = [NSMapTable strongToStrongObjectsMapTable];
+        for (POSRootLens *root in roots) {
+            [_values setObject:(root.currentValue ?: [NSNull null]) forKey:root];
+        }
+    }
+    return self;
+}
+
+- (nullable POSLensValue *)valueForRoot:(POSRootLens *)root {
+    id value = [_values objectForKey:root];
+    POS_CHECK(value != nil);
+    return value == [NSNull null] ? nil : value;
+}
+
+#pragma mark - Public
+
+- (nullable id)valueForLens:(POSLens *)lens {
+    POS_CHECK([lens isKindOfClass:POSMutableLens.class]);
+    POSMutableLens *mutableLens = (POSMutableLens *)lens;
+    return [mutableLens pos_valueInRootValue:[self valueForRoot:mutableLens.pos_rootLens]];
+}
+
+- (BOOL)updateLens:(POSMutableLens *)lens value:(nullable POSLensValue *)value error:(NSError **)error {
+    return [self updateLens:lens withBlock:^id _Nullable(id _Nullable oldValue, NSError **error) {
+        return value;
+    } error:error];
+}
+
+- (BOOL)updateLens:(POSMutableLens *)lens
+         withBlock:(id _Nullable (^)(id _Nullable oldValue, NSError **error))updateBlock
+             error:(NSError **)error {
+    POS_CHECK(lens);
+    POS_CHECK(updateBlock);
+    POSRootLens *root = lens.pos_rootLens;
+    POSLensValue *rootValue = [self valueForRoot:root];
+    NSError *updateError = nil;
+    POSLensValue *updatedRootValue = [lens pos_rootUpdateBlockWithBlock:updateBlock](rootValue, &updateError);
+    if (updateError) {
+        POSAssignError(error, updateError);
+        return NO;
+    }
+    [_values setObject:(updatedRootValue ?: [NSNull null]) forKey:root];
+    return YES;
+}
+
+@end
+
+#pragma mark -
+
+@interface POSLensGroupJournal ()
+@property (nonatomic, readonly) NSString *path;
+@property (nonatomic, readonly) dispatch_queue_t syncQueue;
+/// Entries of the journal file or nil if the file wasn't read yet.
+@property (nonatomic, nullable) NSMutableDictionary<NSString *, id> *entries;
+
+/// Merges entries into the journal file with a single fsync.
+- (BOOL)writeEntries:(NSDictionary<NSString *, id> *)entries error:(NSError **)error;
+
+/// Removes entries from the journal file and the file itself when it becomes empty.
+- (BOOL)removeEntriesWithIdentifiers:(NSArray<NSString *> *)identifiers error:(NSError **)error;
+
+/// Saves the value of the entry into the store and removes the entry from the journal.
+- (BOOL)replayEntryWithIdentifier:(NSString *)identifier intoStore:(id<POSValueStore>)store error:(NSError **)error;
+
+@end
+
+@interface POSLensGroupJournaledStore : NSObject <POSValueStore>
+@property (nonatomic, readonly) POSLensGroupJournal *journal;
+@property (nonatomic, readonly) id<POSValueStore> store;
+@property (nonatomic, readonly) NSString *identifier;
+@end
+
+@implementation POSLensGroupJournaledStore
+
+- (instancetype)initWithJournal:(POSLensGroupJournal *)journal
+                          store:(id<POSValueStore>)store
+                     identifier:(NSString *)identifier {
+    POS_CHECK(journal);
+    POS_CHECK(store);
+    POS_CHECK(identifier);
+    if (self = [super init]) {
+        _journal = journal;
+        _store = store;
+        _identifier = [identifier copy];
+    }
+    return self;
+}
+
+#pragma mark - POSValueStore
+
+- (BOOL)saveValue:(nullable POSLensValue *)value error:(NSError **)error {
+    return [_store saveValue:value error:error];
+}
+
+- (nullable POSLensValue *)loadValue:(NSError **)error {
+    if (![_journal replayEntryWithIdentifier:_identifier intoStore:_store error:error]) {
+        return nil;
+    }
+    return [_store loadValue:error];
+}
+
+@end
+
+#pragma mark -
+
+@implementation POSLensGroupJournal
+
+- (instancetype)initWithPath:(NSString *)path {
+    POS_CHECK(path);
+    if (self = [super init]) {
+        _path = [path copy];
+        _syncQueue = dispatch_queue_create("com.github.pavelosipov.POSLensGroupJournal", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (id<POSValueStore>)storeWithStore:(id<POSValueStore>)store identifier:(NSString *)identifier {
+    return [[POSLensGroupJournaledStore alloc] initWithJournal:self store:store identifier:identifier];
+}
+
+#pragma mark - Internal
+
+- (BOOL)writeEntries:(NSDictionary<NSString *, id> *)entries error:(NSError **)error {
+    __block BOOL written = NO;
+    __block NSError *writeError = nil;
+    dispatch_sync(_syncQueue, ^{
+        if ([self p_readEntries:&writeError]) {
+            [self.entries addEntriesFromDictionary:entries];
+            written = [self p_writeEntries:&writeError];
+        }
+    });
+    POSAssignError(error, writeError);
+    return written;
+}
+
+- (BOOL)removeEntriesWithIdentifiers:(NSArray<NSString *> *)identifiers error:(NSError **)error {
+    __block BOOL removed = NO;
+    __block NSError *removalError = nil;
+    dispatch_sync(_syncQueue, ^{
+        if ([self p_readEntries:&removalError]) {
+            [self.entries removeObjectsForKeys:identifiers];
+            removed = [self p_writeEntries:&removalError];
+        }
+    });
+    POSAssignError(error, removalError);
+    return removed;
+}
+
+- (BOOL)replayEntryWithIdentifier:(NSString *)identifier intoStore:(id<POSValueStore>)store error:(NSError **)error {
+    __block BOOL replayed = NO;
+    __block NSError *replayError = nil;
+    dispatch_sync(_syncQueue, ^{
+        if (![self p_readEntries:&replayError]) {
+            return;
+        }
+        id value = self.entries[identifier];
+        if (!value) {
+            replayed = YES;
+        } else if ([store saveValue:(value == [NSNull null] ? nil : value) error:&replayError]) {
+            [self.entries removeObjectForKey:identifier];
+            replayed = [self p_writeEntries:&replayError];
+        }
+    });
+    POSAssignError(error, replayError);
+    return replayed;
+}
+
+#pragma mark - Private
+
+- (BOOL)p_readEntries:(NSError **)error {
+    if (_entries) {
+        return YES;
+    }
+    if (![[NSFileManager defaultManager] fileExistsAtPath:_path]) {
+        self.entries = [NSMutableDictionary new];
+        return YES;
+    }
+    NSError *cocoaError = nil;
+    NSData *data = [NSData dataWithContentsOfFile:_path options:0 error:&cocoaError];
+    if (!data) {
+        POSAssignError(error, [NSError pos_fileErrorWithPath:_path reason:cocoaError]);
+        return NO;
+    }
+    NSDictionary<NSString *, id> *entries = nil;
+    @try {
+        entries = POSUnarchiveObject(data);
+    } @catch (NSException *exception) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        return NO;
+    }
+    if (!POSIsStringKeyedDictionary(entries)) {
+        POSAssignError(error, [NSError pos_lensErrorWithFormat:@"Malformed lens group journal: %@", entries]);
+        return NO;
+    }
+    self.entries = [entries mutableCopy];
+    return YES;
+}
+
+///
+/// The journal which outlives its commit is replayed on the next load of the stores and
+/// may overwrite newer values, so failures are reported instead of being ignored.
+///
+- (BOOL)p_writeEntries:(NSError **)error {
+    if (_entries.count == 0) {
+        if (unlink(_path.fileSystemRepresentation) == 0 || errno == ENOENT) {
+            return YES;
+        }
+        NSError *reason = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        POSAssignError(error, [NSError pos_fileErrorWithPath:_path reason:reason]);
+        return NO;
+    }
+    NSData *data = nil;
+    @try {
+        data = POSArchiveObject(_entries);
+    } @catch (NSException *exception) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        return NO;
+    }
+    POSAtomicFileWriter *writer = [[POSAtomicFileWriter alloc] initWithFilePath:_path];
+    return [writer open:error] && [writer writeData:data error:error] && [writer commit:error];
+}
+
+@end
+
+#pragma mark -
+
+@interface POSLensGroup ()
+@property (nonatomic, readonly) NSArray<POSRootLens *> *roots;
+@property (nonatomic, readonly) NSArray<POSRootLens *> *lockingRoots;
+@property (nonatomic, readonly, nullable) POSLensGroupJournal *journal;
+@property (nonatomic, readonly, nullable) id<POSLogger> logger;
+@end
+
+@implementation POSLensGroup
+
+- (instancetype)initWithRoots:(NSArray<POSRootLens *> *)roots
+                      journal:(nullable POSLensGroupJournal *)journal
+                       logger:(nullable id<POSLogger>)logger {
+    if (self = [super init]) {
+        _roots = [roots copy];
+        _lockingRoots = [roots sortedArrayUsingComparator:^NSComparisonResult(id left, id right) {
+            uintptr_t l = (uintptr_t)(__bridge void *)left;
+            uintptr_t r = (uintptr_t)(__bridge void *)right;
+            return l < r ? NSOrderedAscending : (l > r ? NSOrderedDescending : NSOrderedSame);
+        }];
+        _journal = journal;
+        _logger = logger;
+    }
+    return self;
+}
+
++ (instancetype)groupWithLenses:(NSArray<POSMutableLens *> *)lenses
+                        journal:(nullable POSLensGroupJournal *)journal
+                         logger:(nullable id<POSLogger>)logger {
+    POS_CHECK(lenses.count > 0);
+    NSMutableArray<POSRootLens *> *roots = [NSMutableArray new];
+    for (POSMutableLens *lens in lenses) {
+        POSRootLens *root = lens.pos_rootLens;
+        if ([roots indexOfObjectIdenticalTo:root] == NSNotFound) {
+            POS_CHECK(!journal || ([root.store isKindOfClass:POSLensGroupJournaledStore.class] &&
+                                   ((POSLensGroupJournaledStore *)root.store).journal == journal));
+            [roots addObject:root];
+        }
+    }
+    return [[self alloc] initWithRoots:roots journal:journal logger:logger];
+}
+
+#pragma mark - Public
+
+- (BOOL)updateWithBlock:(BOOL (^)(POSLensTransaction *transaction, NSError **error))updateBlock
+                  error:(NSError **)error {
+    POS_CHECK(updateBlock);
+    __block BOOL committed = NO;
+    __block NSError *updateError = nil;
+    NSMutableArray<POSRootLens *> *updatedRoots = [NSMutableArray new];
+    NSMutableArray<POSLensValueUpdate *> *updates = [NSMutableArray new];
+    POSLensUpdatePriority priority = POSLensUpdatePriorityOfCurrentThread();
+    [self p_performWithPriority:priority fromIndex:0 block:^{
+        POSLensTransaction *transaction = [[POSLensTransaction alloc] initWithRoots:self->_roots];
+        if (!updateBlock(transaction, &updateError)) {
+            return;
+        }
+        for (POSRootLens *root in self->_roots) {
+            POSLensValue *oldValue = root.currentValue;
+            POSLensValue *actualValue = [root canonicalValue:[transaction valueForRoot:root]];
+            if (actualValue == oldValue || [actualValue isEqual:oldValue]) {
+                continue;
+            }
+            [updatedRoots addObject:root];
+            [updates addObject:[[POSLensValueUpdate alloc] initWithOldValue:oldValue actualValue:actualValue]];
+        }
+        if (![self p_commitUpdates:updates ofRoots:updatedRoots error:&updateError]) {
+            return;
+        }
+        [self p_performWithBarriersOfRoots:updatedRoots fromIndex:0 block:^{
+            [updatedRoots enumerateObjectsUsingBlock:^(POSRootLens *root, NSUInteger idx, BOOL *stop) {
+                root.currentValue = updates[idx].actualValue;
+            }];
+        }];
+        committed = YES;
+    }];
+    if (!committed) {
+        if (error) {
+            POSAssignError(error, updateError);
+        } else if (updateError) {
+            [_logger logError:@"Lens group: Failed to update values: %@", updateError];
+        }
+        return NO;
+    }
+    [updatedRoots enumerateObjectsUsingBlock:^(POSRootLens *root, NSUInteger idx, BOOL *stop) {
+        [root.updatesSubject sendNext:updates[idx]];
+    }];
+    return YES;
+}
+
+#pragma mark - Private
+
+- (void)p_performWithPriority:(POSLensUpdatePriority)priority
+                    fromIndex:(NSUInteger)index
+                        block:(dispatch_block_t)block {
+    if (index == _lockingRoots.count) {
+        block();
+        return;
+    }
+    [_lockingRoots[index].scheduler performWithPriority:priority block:^{
+        [self p_performWithPriority:priority fromIndex:index + 1 block:block];
+    }];
+}
+
+- (void)p_performWithBarriersOfRoots:(NSArray<POSRootLens *> *)roots
+                           fromIndex:(NSUInteger)index
+                               block:(dispatch_block_t)block {
+    if (index == roots.count) {
+        block();
+        return;
+    }
+    dispatch_barrier_sync(roots[index].syncQueue, ^{
+        [self p_performWithBarriersOfRoots:roots fromIndex:index + 1 block:block];
+    });
+}
+
+- (BOOL)p_commitUpdates:(NSArray<POSLensValueUpdate *> *)updates
+                ofRoots:(NSArray<POSRootLens *> *)roots
+                  error:(NSError **)error {
+    if (roots.count == 0) {
+        return YES;
+    }
+    NSMutableDictionary<NSString *, id> *entries = [NSMutableDictionary new];
+    if (_journal) {
+        [roots enumerateObjectsUsingBlock:^(POSRootLens *root, NSUInteger idx, BOOL *stop) {
+            NSString *identifier = ((POSLensGroupJournaledStore *)root.store).identifier;
+            entries[identifier] = updates[idx].actualValue ?: [NSNull null];
+        }];
+    }
+    if (_journal && ![_journal writeEntries:entries error:error]) {
+        [self p_removeJournalEntriesLoggingError:entries.allKeys];
+        return NO;
+    }
+    for (NSUInteger i = 0; i < roots.count; ++i) {
+        if (![roots[i] persistValue:updates[i].actualValue error:error]) {
+            [self p_rollbackUpdates:[updates subarrayWithRange:NSMakeRange(0, i)]
+                            ofRoots:[roots subarrayWithRange:NSMakeRange(0, i)]];
+            [self p_removeJournalEntriesLoggingError:entries.allKeys];
+            return NO;
+        }
+    }
+    [self p_removeJournalEntriesLoggingError:entries.allKeys];
+    return YES;
+}
+
+- (void)p_rollbackUpdates:(NSArray<POSLensValueUpdate *> *)updates ofRoots:(NSArray<POSRootLens *> *)roots {
+    for (NSUInteger i = 0; i < roots.count; ++i) {
+        NSError *rollbackError = nil;
+        if (![roots[i] persistValue:updates[i].oldValue error:&rollbackError]) {
+            [_logger logError:@"Lens group: Failed to rollback value in %@: %@", roots[i].store, rollbackError];
+        }
+    }
+}
+
+- (void)p_removeJournalEntriesLoggingError:(NSArray<NSString *> *)identifiers {
+    NSError *removalError = nil;
+    if (_journal && ![_journal removeEntriesWithIdentifiers:identifiers error:&removalError]) {
+        [_logger logError:@"Lens group: Failed to remove journal %@: %@", _journal.path, removalError];
+    }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
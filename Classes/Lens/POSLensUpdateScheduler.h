@@ -0,0 +1,48 @@
+//
+//  POSLensUpdateScheduler.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensWaitMetrics.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+//
+// Private scheduler of the root lens updates. Don't use it in applications.
+//
+
+/// Number of priority classes.
+FOUNDATION_EXTERN const NSInteger POSLensUpdatePriorityCount;
+
+/// Priority of the updates which are performed on the current thread.
+FOUNDATION_EXTERN POSLensUpdatePriority POSLensUpdatePriorityOfCurrentThread(void);
+
+#pragma mark -
+
+///
+/// Serializes updates of the root lens giving way to the more urgent ones.
+///
+/// @discussion When the update completes, the scheduler passes control to the waiting update with
+///             the highest priority. If a more urgent update has to wait for the less urgent one,
+///             the scheduler raises QoS class of the thread which performs the last one until
+///             the urgent update gets its turn.
+///
+/// @remarks    The scheduler is not reentrant.
+///
+@interface POSLensUpdateScheduler : NSObject
+
+///
+/// @brief      Performs the block exclusively.
+/// @discussion The block is performed on the calling thread after all waiting blocks with higher priority.
+///
+- (void)performWithPriority:(POSLensUpdatePriority)priority block:(void (^ NS_NOESCAPE)(void))block;
+
+/// Snapshot of the wait time statistics for the specified priority.
+- (POSLensWaitMetrics *)waitMetricsForPriority:(POSLensUpdatePriority)priority;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,159 @@
+//
+//  POSLensUpdateScheduler.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensUpdateScheduler.h"
+#include <mach/mach_time.h>
+#include <pthread.h>
+#include <pthread/qos.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+const NSInteger POSLensUpdatePriorityCount = POSLensUpdatePriorityUrgent + 1;
+
+POSLensUpdatePriority POSLensUpdatePriorityOfCurrentThread(void) {
+    switch (qos_class_self()) {
+        case QOS_CLASS_USER_INTERACTIVE:
+        case QOS_CLASS_USER_INITIATED:
+            return POSLensUpdatePriorityUrgent;
+        case QOS_CLASS_UTILITY:
+        case QOS_CLASS_BACKGROUND:
+            return POSLensUpdatePriorityBackground;
+        default:
+            return POSLensUpdatePriorityDefault;
+    }
+}
+
+static NSTimeInterval POSTimeIntervalFromMachTime(uint64_t machTime) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (NSTimeInterval)machTime * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+typedef struct {
+    NSUInteger count;
+    uint64_t totalWaitTime;
+    uint64_t maxWaitTime;
+} POSLensWaitStatistics;
+
+#pragma mark -
+
+@implementation POSLensWaitMetrics
+
+- (instancetype)initWithPriority:(POSLensUpdatePriority)priority statistics:(POSLensWaitStatistics)statistics {
+    if (self = [super init]) {
+        _priority = priority;
+        _count = statistics.count;
+        _totalWaitTime = POSTimeIntervalFromMachTime(statistics.totalWaitTime);
+        _maxWaitTime = POSTimeIntervalFromMachTime(statistics.maxWaitTime);
+    }
+    return self;
+}
+
+- (NSTimeInterval)averageWaitTime {
+    return _count > 0 ? _totalWaitTime / _count : 0;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@ priority=%@ count=%@ avg=%.6f max=%.6f>",
+            NSStringFromClass(self.class), @(_priority), @(_count), self.averageWaitTime, _maxWaitTime];
+}
+
+@end
+
+#pragma mark -
+
+@implementation POSLensUpdateScheduler {
+    pthread_mutex_t _mutex;
+    pthread_cond_t _condition;
+    BOOL _busy;
+    pthread_t _owner;
+    POSLensUpdatePriority _ownerPriority;
+    NSUInteger _waitingCounts[POSLensUpdatePriorityUrgent + 1];
+    POSLensWaitStatistics _statistics[POSLensUpdatePriorityUrgent + 1];
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        pthread_mutex_init(&_mutex, NULL);
+        pthread_cond_init(&_condition, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_cond_destroy(&_condition);
+    pthread_mutex_destroy(&_mutex);
+}
+
+#pragma mark - Public
+
+- (void)performWithPriority:(POSLensUpdatePriority)priority block:(void (^ NS_NOESCAPE)(void))block {
+    POS_CHECK(priority >= POSLensUpdatePriorityBackground && priority <= POSLensUpdatePriorityUrgent);
+    POS_CHECK(block);
+    uint64_t requestTime = mach_absolute_time();
+    pthread_override_t override = NULL;
+    pthread_t overriddenThread = NULL;
+    pthread_mutex_lock(&_mutex);
+    _waitingCounts[priority] += 1;
+    while (_busy || [self p_hasWaitersAbovePriority:priority]) {
+        if (_busy && _ownerPriority < priority && overriddenThread != _owner) {
+            if (override) {
+                pthread_override_qos_class_end_np(override);
+            }
+            qos_class_t qos = qos_class_self();
+            override = pthread_override_qos_class_start_np(_owner, qos != QOS_CLASS_UNSPECIFIED ? qos : QOS_CLASS_DEFAULT, 0);
+            overriddenThread = _owner;
+        }
+        pthread_cond_wait(&_condition, &_mutex);
+    }
+    _waitingCounts[priority] -= 1;
+    _busy = YES;
+    _owner = pthread_self();
+    _ownerPriority = priority;
+    uint64_t waitTime = mach_absolute_time() - requestTime;
+    POSLensWaitStatistics *statistics = &_statistics[priority];
+    statistics->count += 1;
+    statistics->totalWaitTime += waitTime;
+    statistics->maxWaitTime = MAX(statistics->maxWaitTime, waitTime);
+    pthread_mutex_unlock(&_mutex);
+    if (override) {
+        pthread_override_qos_class_end_np(override);
+    }
+    block();
+    pthread_mutex_lock(&_mutex);
+    _busy = NO;
+    _owner = NULL;
+    pthread_cond_broadcast(&_condition);
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (POSLensWaitMetrics *)waitMetricsForPriority:(POSLensUpdatePriority)priority {
+    POS_CHECK(priority >= POSLensUpdatePriorityBackground && priority <= POSLensUpdatePriorityUrgent);
+    pthread_mutex_lock(&_mutex);
+    POSLensWaitStatistics statistics = _statistics[priority];
+    pthread_mutex_unlock(&_mutex);
+    return [[POSLensWaitMetrics alloc] initWithPriority:priority statistics:statistics];
+}
+
+#pragma mark - Private
+
+- (BOOL)p_hasWaitersAbovePriority:(POSLensUpdatePriority)priority {
+    for (NSInteger i = priority + 1; i < POSLensUpdatePriorityCount; ++i) {
+        if (_waitingCounts[i] > 0) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,61 @@
+//
+//  POSLensValueInterner.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensValue.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///
+/// Marks immutable classes whose instances may be shared between equal subtrees of the objects' graph.
+///
+/// @remarks    Conforming class should implement isEqual: and hash methods consistently,
+///             and should never mutate its instances after creation.
+///
+@protocol POSLensInternableValue <NSObject>
+@end
+
+#pragma mark -
+
+///
+/// Weak hash-consing table which canonicalizes immutable values.
+///
+/// @discussion Interner returns a single shared instance for all equal values. It processes the graph
+///             bottom-up and rebuilds NSDictionary, NSArray and NSSet containers only if some of their
+///             elements were replaced, so the containers are compared by the identity of their elements.
+///             Already interned subgraphs are recognized without traversal, which makes interning after
+///             "copy on write" updates proportional to the size of the nodes on the updated path.
+///
+///             NSString, NSNumber, NSDate, NSData, NSUUID and NSURL instances as well as objects which
+///             conform to POSLensInternableValue protocol are interned. Other objects are returned as is,
+///             and they are not looked into. NSNumbers with different types are never unified, so @YES
+///             and @1 stay different.
+///
+///             Interner doesn't retain values. Entries disappear when the last owner of the value releases it.
+///
+/// @remarks    The class is thread-safe. The table is split into independently locked parts,
+///             so threads which intern different values rarely wait for each other.
+///
+@interface POSLensValueInterner : NSObject
+
+/// Interner which is shared across the application.
++ (instancetype)sharedInterner;
+
+/// Number of the alive canonical values.
+@property (nonatomic, readonly) NSUInteger count;
+
+///
+/// @brief      Returns the canonical instance of the value.
+///
+/// @discussion The result is equal to the argument, but it may be another instance, which
+///             was interned earlier. Mutable containers are converted to immutable ones.
+///
+- (nullable id)internValue:(nullable id)value;
+
+@end
+
+NS_ASSUME_NONNULL_END
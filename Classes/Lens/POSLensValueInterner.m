@@ -0,0 +1,299 @@
+//
+//  POSLensValueInterner.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensValueInterner.h"
+#include <pthread.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Number of independently locked parts of the table. Must be a power of two.
+static const NSUInteger kPOSInternShardCount = 16;
+
+typedef NS_ENUM(NSInteger, POSInternFamily) {
+    POSInternFamilyNone = 0,
+    POSInternFamilyDictionary,
+    POSInternFamilyArray,
+    POSInternFamilySet,
+    POSInternFamilyString,
+    POSInternFamilyNumber,
+    POSInternFamilyDate,
+    POSInternFamilyData,
+    POSInternFamilyUUID,
+    POSInternFamilyURL,
+    POSInternFamilyCustom
+};
+
+static POSInternFamily POSInternFamilyOfValue(id value) {
+    if ([value isKindOfClass:NSDictionary.class]) {
+        return POSInternFamilyDictionary;
+    } else if ([value isKindOfClass:NSArray.class]) {
+        return POSInternFamilyArray;
+    } else if ([value isKindOfClass:NSSet.class]) {
+        return POSInternFamilySet;
+    } else if ([value isKindOfClass:NSString.class]) {
+        return POSInternFamilyString;
+    } else if ([value isKindOfClass:NSDecimalNumber.class]) {
+        // NSDecimalNumber is equal to NSNumber with the same value, but it has different semantics.
+        return POSInternFamilyCustom;
+    } else if ([value isKindOfClass:NSNumber.class]) {
+        return POSInternFamilyNumber;
+    } else if ([value isKindOfClass:NSDate.class]) {
+        return POSInternFamilyDate;
+    } else if ([value isKindOfClass:NSData.class]) {
+        return POSInternFamilyData;
+    } else if ([value isKindOfClass:NSUUID.class]) {
+        return POSInternFamilyUUID;
+    } else if ([value isKindOfClass:NSURL.class]) {
+        return POSInternFamilyURL;
+    } else if ([value conformsToProtocol:@protocol(POSLensInternableValue)]) {
+        return POSInternFamilyCustom;
+    }
+    return POSInternFamilyNone;
+}
+
+NS_INLINE NSUInteger POSInternPointerHash(id value) {
+    return (NSUInteger)(((uintptr_t)(__bridge void *)value >> 4) * (uintptr_t)0x9E3779B97F4A7C15ULL);
+}
+
+//
+// Elements of interned containers are canonical, so containers are hashed
+// and compared by the identity of their elements without going deeper.
+//
+
+static NSUInteger POSInternHash(const void *item, NSUInteger (* _Nullable size)(const void *item)) {
+    id value = (__bridge id)item;
+    POSInternFamily family = POSInternFamilyOfValue(value);
+    switch (family) {
+        case POSInternFamilyDictionary: {
+            __block NSUInteger hash = [value count];
+            [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+                hash += POSInternPointerHash(key) ^ (POSInternPointerHash(object) * 31);
+            }];
+            return hash;
+        }
+        case POSInternFamilyArray: {
+            NSUInteger hash = [value count];
+            for (id element in (NSArray *)value) {
+                hash = hash * 31 + POSInternPointerHash(element);
+            }
+            return hash;
+        }
+        case POSInternFamilySet: {
+            NSUInteger hash = [value count];
+            for (id element in (NSSet *)value) {
+                hash += POSInternPointerHash(element);
+            }
+            return hash;
+        }
+        case POSInternFamilyNumber:
+            return [value hash] ^ (NSUInteger)[(NSNumber *)value objCType][0];
+        default:
+            return [value hash] ^ (NSUInteger)family;
+    }
+}
+
+static BOOL POSInternIsEqual(const void *leftItem,
+                             const void *rightItem,
+                             NSUInteger (* _Nullable size)(const void *item)) {
+    if (leftItem == rightItem) {
+        return YES;
+    }
+    id left = (__bridge id)leftItem;
+    id right = (__bridge id)rightItem;
+    POSInternFamily family = POSInternFamilyOfValue(left);
+    if (family != POSInternFamilyOfValue(right)) {
+        return NO;
+    }
+    switch (family) {
+        case POSInternFamilyDictionary: {
+            NSDictionary *rightDictionary = right;
+            if ([left count] != rightDictionary.count) {
+                return NO;
+            }
+            __block BOOL equal = YES;
+            [(NSDictionary *)left enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+                equal = (rightDictionary[key] == object);
+                *stop = !equal;
+            }];
+            return equal;
+        }
+        case POSInternFamilyArray: {
+            NSArray *leftArray = left;
+            NSArray *rightArray = right;
+            if (leftArray.count != rightArray.count) {
+                return NO;
+            }
+            for (NSUInteger i = 0, n = leftArray.count; i < n; ++i) {
+                if (leftArray[i] != rightArray[i]) {
+                    return NO;
+                }
+            }
+            return YES;
+        }
+        case POSInternFamilySet: {
+            NSSet *rightSet = right;
+            if ([left count] != rightSet.count) {
+                return NO;
+            }
+            for (id element in (NSSet *)left) {
+                if ([rightSet member:element] != element) {
+                    return NO;
+                }
+            }
+            return YES;
+        }
+        case POSInternFamilyNumber:
+            return (strcmp([(NSNumber *)left objCType], [(NSNumber *)right objCType]) == 0 &&
+                    [left isEqual:right]);
+        case POSInternFamilyCustom:
+            return [left class] == [right class] && [left isEqual:right];
+        default:
+            return [left isEqual:right];
+    }
+}
+
+#pragma mark -
+
+@interface POSLensValueInterner ()
+/// Canonical values are spread between tables by their hash, so unrelated values don't contend for a lock.
+@property (nonatomic, readonly) NSArray<NSHashTable *> *tables;
+@end
+
+@implementation POSLensValueInterner {
+    pthread_mutex_t _mutexes[kPOSInternShardCount];
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        NSPointerFunctions *functions = [NSPointerFunctions pointerFunctionsWithOptions:
+                                         NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPersonality];
+        functions.hashFunction = POSInternHash;
+        functions.isEqualFunction = POSInternIsEqual;
+        NSMutableArray<NSHashTable *> *tables = [NSMutableArray arrayWithCapacity:kPOSInternShardCount];
+        for (NSUInteger i = 0; i < kPOSInternShardCount; ++i) {
+            pthread_mutex_init(&_mutexes[i], NULL);
+            [tables addObject:[[NSHashTable alloc] initWithPointerFunctions:functions capacity:0]];
+        }
+        _tables = [tables copy];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < kPOSInternShardCount; ++i) {
+        pthread_mutex_destroy(&_mutexes[i]);
+    }
+}
+
++ (instancetype)sharedInterner {
+    static POSLensValueInterner *interner;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        interner = [POSLensValueInterner new];
+    });
+    return interner;
+}
+
+#pragma mark - Public
+
+- (NSUInteger)count {
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < kPOSInternShardCount; ++i) {
+        pthread_mutex_lock(&_mutexes[i]);
+        count += _tables[i].allObjects.count;
+        pthread_mutex_unlock(&_mutexes[i]);
+    }
+    return count;
+}
+
+- (nullable id)internValue:(nullable id)value {
+    if (value == nil) {
+        return nil;
+    }
+    return [self p_internValue:value];
+}
+
+#pragma mark - Private
+
+- (id)p_internValue:(id)value {
+    POSInternFamily family = POSInternFamilyOfValue(value);
+    if (family == POSInternFamilyNone) {
+        return value;
+    }
+    if ([self p_memberOfTable:value] == value) {
+        return value;
+    }
+    id candidate = nil;
+    switch (family) {
+        case POSInternFamilyDictionary: {
+            NSDictionary *dictionary = value;
+            NSMutableArray *keys = [NSMutableArray arrayWithCapacity:dictionary.count];
+            NSMutableArray *objects = [NSMutableArray arrayWithCapacity:dictionary.count];
+            __block BOOL changed = NO;
+            [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+                id internedKey = [self p_internValue:key];
+                id internedObject = [self p_internValue:object];
+                changed = changed || internedKey != key || internedObject != object;
+                [keys addObject:internedKey];
+                [objects addObject:internedObject];
+            }];
+            candidate = changed ? [NSDictionary dictionaryWithObjects:objects forKeys:keys] : [dictionary copy];
+            break;
+        }
+        case POSInternFamilyArray: {
+            NSArray *array = value;
+            NSMutableArray *elements = [NSMutableArray arrayWithCapacity:array.count];
+            BOOL changed = NO;
+            for (id element in array) {
+                id internedElement = [self p_internValue:element];
+                changed = changed || internedElement != element;
+                [elements addObject:internedElement];
+            }
+            candidate = changed ? [elements copy] : [array copy];
+            break;
+        }
+        case POSInternFamilySet: {
+            NSSet *set = value;
+            NSMutableSet *elements = [NSMutableSet setWithCapacity:set.count];
+            BOOL changed = NO;
+            for (id element in set) {
+                id internedElement = [self p_internValue:element];
+                changed = changed || internedElement != element;
+                [elements addObject:internedElement];
+            }
+            candidate = changed ? [elements copy] : [set copy];
+            break;
+        }
+        case POSInternFamilyCustom:
+            candidate = value;
+            break;
+        default:
+            candidate = [value copy];
+            break;
+    }
+    NSUInteger shard = POSInternHash((__bridge void *)candidate, NULL) & (kPOSInternShardCount - 1);
+    pthread_mutex_lock(&_mutexes[shard]);
+    id existingValue = [_tables[shard] member:candidate];
+    if (!existingValue) {
+        [_tables[shard] addObject:candidate];
+    }
+    pthread_mutex_unlock(&_mutexes[shard]);
+    return existingValue ?: candidate;
+}
+
+- (nullable id)p_memberOfTable:(id)value {
+    NSUInteger shard = POSInternHash((__bridge void *)value, NULL) & (kPOSInternShardCount - 1);
+    pthread_mutex_lock(&_mutexes[shard]);
+    id member = [_tables[shard] member:value];
+    pthread_mutex_unlock(&_mutexes[shard]);
+    return member;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,39 @@
+//
+//  POSLensWaitMetrics.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <POSErrorHandling/POSErrorHandling.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+///
+/// Priority of the lens update. It is derived from the QoS class of the updating thread:
+/// user-interactive and user-initiated work is urgent, utility and background work is background.
+///
+typedef NS_ENUM(NSInteger, POSLensUpdatePriority) {
+    POSLensUpdatePriorityBackground = 0,
+    POSLensUpdatePriorityDefault = 1,
+    POSLensUpdatePriorityUrgent = 2
+};
+
+///
+/// Statistics of the time which updates of some priority spent waiting for their turn.
+///
+@interface POSLensWaitMetrics : NSObject
+
+@property (nonatomic, readonly) POSLensUpdatePriority priority;
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSTimeInterval totalWaitTime;
+@property (nonatomic, readonly) NSTimeInterval maxWaitTime;
+@property (nonatomic, readonly) NSTimeInterval averageWaitTime;
+
+POS_INIT_UNAVAILABLE
+
+@end
+
+NS_ASSUME_NONNULL_END
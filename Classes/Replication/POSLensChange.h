@@ -0,0 +1,59 @@
+//
+//  POSLensChange.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensValue.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(uint8_t, POSLensChangeType) {
+    POSLensChangeTypeSet = 0,
+    POSLensChangeTypeRemove = 1
+};
+
+///
+/// Modification of the single node of the objects' graph at the specified key path.
+///
+@interface POSLensChange : NSObject <NSCoding>
+
+@property (nonatomic, readonly) POSLensChangeType type;
+
+/// Keys from the root value to the modified node. Empty array means the root value itself.
+@property (nonatomic, readonly) NSArray<NSString *> *keys;
+
+/// New value of the node or nil for removal.
+@property (nonatomic, readonly, nullable) POSLensValue *value;
+
+- (instancetype)initWithType:(POSLensChangeType)type
+                        keys:(NSArray<NSString *> *)keys
+                       value:(nullable POSLensValue *)value NS_DESIGNATED_INITIALIZER;
+
+///
+/// @brief      Computes the minimal set of changes which transforms one value into another.
+///
+/// @discussion Dictionaries with string keys are compared recursively, other values are replaced entirely.
+///             Lens updates preserve unchanged subgraphs, so identical nodes are skipped without comparison.
+///
++ (NSArray<POSLensChange *> *)changesFromValue:(nullable POSLensValue *)fromValue
+                                       toValue:(nullable POSLensValue *)toValue;
+
+///
+/// @brief      Applies changes to the value using "copy on write" idiom.
+///
+/// @discussion The method returns nil and `error` out parameter if some change refers to the node
+///             whose parent doesn't exist in the value.
+///
++ (nullable POSLensValue *)valueByApplyingChanges:(NSArray<POSLensChange *> *)changes
+                                          toValue:(nullable POSLensValue *)value
+                                            error:(NSError **)error;
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
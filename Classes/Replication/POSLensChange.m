@@ -0,0 +1,164 @@
+//
+//  POSLensChange.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensChange.h"
+#import "NSError+POSLens.h"
+#import "POSKeyedArchiving.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static NSString * const kPOSLensChangeTypeKey = @"type";
+static NSString * const kPOSLensChangeKeysKey = @"keys";
+static NSString * const kPOSLensChangeValueKey = @"value";
+
+@implementation POSLensChange
+
+- (instancetype)initWithType:(POSLensChangeType)type
+                        keys:(NSArray<NSString *> *)keys
+                       value:(nullable POSLensValue *)value {
+    POS_CHECK(keys);
+    POS_CHECK(type == POSLensChangeTypeSet || value == nil);
+    if (self = [super init]) {
+        _type = type;
+        _keys = [keys copy];
+        _value = value;
+    }
+    return self;
+}
+
+- (BOOL)isEqual:(nullable POSLensChange *)other {
+    if (self == other) {
+        return YES;
+    }
+    if (![other isMemberOfClass:self.class]) {
+        return NO;
+    }
+    return (_type == other.type &&
+            [_keys isEqualToArray:other.keys] &&
+            POSObjectsAreEqual(_value, other.value));
+}
+
+- (NSUInteger)hash {
+    return _keys.hash ^ _type;
+}
+
+- (NSString *)description {
+    NSString *keyPath = [_keys componentsJoinedByString:@"."];
+    return (_type == POSLensChangeTypeSet
+            ? [NSString stringWithFormat:@"set '%@' to %@", keyPath, _value]
+            : [NSString stringWithFormat:@"remove '%@'", keyPath]);
+}
+
+#pragma mark - NSCoding
+
+- (nullable instancetype)initWithCoder:(NSCoder *)aDecoder {
+    NSInteger type = [aDecoder decodeIntegerForKey:kPOSLensChangeTypeKey];
+    NSArray<NSString *> *keys = [aDecoder decodeObjectForKey:kPOSLensChangeKeysKey];
+    if ((type != POSLensChangeTypeSet && type != POSLensChangeTypeRemove) ||
+        ![keys isKindOfClass:NSArray.class]) {
+        return nil;
+    }
+    POSLensValue *value = (type == POSLensChangeTypeSet ? [aDecoder decodeObjectForKey:kPOSLensChangeValueKey] : nil);
+    return [self initWithType:type keys:keys value:value];
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [aCoder encodeInteger:_type forKey:kPOSLensChangeTypeKey];
+    [aCoder encodeObject:_keys forKey:kPOSLensChangeKeysKey];
+    if (_value) {
+        [aCoder encodeObject:_value forKey:kPOSLensChangeValueKey];
+    }
+}
+
+#pragma mark - Public
+
++ (NSArray<POSLensChange *> *)changesFromValue:(nullable POSLensValue *)fromValue
+                                       toValue:(nullable POSLensValue *)toValue {
+    NSMutableArray<POSLensChange *> *changes = [NSMutableArray new];
+    [self p_collectChangesFromValue:fromValue toValue:toValue keys:@[] changes:changes];
+    return changes;
+}
+
++ (nullable POSLensValue *)valueByApplyingChanges:(NSArray<POSLensChange *> *)changes
+                                          toValue:(nullable POSLensValue *)value
+                                            error:(NSError **)error {
+    POS_CHECK(changes);
+    POSLensValue *result = value;
+    for (POSLensChange *change in changes) {
+        NSError *applyError = nil;
+        result = [self p_applyChange:change toValue:result keyIndex:0 error:&applyError];
+        if (applyError) {
+            POSAssignError(error, applyError);
+            return nil;
+        }
+    }
+    return result;
+}
+
+#pragma mark - Private
+
++ (void)p_collectChangesFromValue:(nullable POSLensValue *)fromValue
+                          toValue:(nullable POSLensValue *)toValue
+                             keys:(NSArray<NSString *> *)keys
+                          changes:(NSMutableArray<POSLensChange *> *)changes {
+    if (fromValue == toValue) {
+        return;
+    }
+    if (toValue == nil) {
+        [changes addObject:[[POSLensChange alloc] initWithType:POSLensChangeTypeRemove keys:keys value:nil]];
+        return;
+    }
+    if (POSIsStringKeyedDictionary(fromValue) && POSIsStringKeyedDictionary(toValue)) {
+        NSDictionary<NSString *, id> *fromDictionary = (id)fromValue;
+        NSDictionary<NSString *, id> *toDictionary = (id)toValue;
+        for (NSString *key in fromDictionary) {
+            if (toDictionary[key] == nil) {
+                [changes addObject:[[POSLensChange alloc]
+                                    initWithType:POSLensChangeTypeRemove
+                                    keys:[keys arrayByAddingObject:key]
+                                    value:nil]];
+            }
+        }
+        for (NSString *key in toDictionary) {
+            [self p_collectChangesFromValue:fromDictionary[key]
+                                    toValue:toDictionary[key]
+                                       keys:[keys arrayByAddingObject:key]
+                                    changes:changes];
+        }
+        return;
+    }
+    if ([toValue isEqual:fromValue]) {
+        return;
+    }
+    [changes addObject:[[POSLensChange alloc] initWithType:POSLensChangeTypeSet keys:keys value:toValue]];
+}
+
++ (nullable POSLensValue *)p_applyChange:(POSLensChange *)change
+                                 toValue:(nullable POSLensValue *)value
+                                keyIndex:(NSUInteger)keyIndex
+                                   error:(NSError **)error {
+    if (keyIndex == change.keys.count) {
+        return change.value;
+    }
+    if (value == nil) {
+        POSAssignError(error, [NSError pos_lensErrorWithFormat:
+                               @"Failed to apply change %@: there is no parent value.", change]);
+        return nil;
+    }
+    NSString *key = change.keys[keyIndex];
+    POSLensValue *childValue = [value pos_valueForKey:key];
+    POSLensValue *updatedChildValue = [self p_applyChange:change toValue:childValue keyIndex:keyIndex + 1 error:error];
+    if (*error) {
+        return nil;
+    }
+    return [value pos_setValue:updatedChildValue forKey:key];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
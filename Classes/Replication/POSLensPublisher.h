@@ -0,0 +1,55 @@
+//
+//  POSLensPublisher.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLens.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///
+/// Streams changes of the lens value to POSLensReplica instances in other processes
+/// through the Unix domain socket.
+///
+/// @discussion Publisher sends the snapshot of the value to every follower when it connects
+///             or asks for resynchronization. After that each committed update of the lens is
+///             published as a list of key path changes with the next sequence number. Bursts of
+///             updates may be coalesced into a single message.
+///
+///             Publisher never blocks on slow followers. If the follower doesn't read messages
+///             and its outgoing buffer exceeds the limit, then publisher stops sending changes to it
+///             and sends the snapshot of the latest value as soon as the follower reads pending messages.
+///
+///             Only processes of the same user may connect to the socket. Messages from followers
+///             are decoded with NSSecureCoding, so they can't make the publisher instantiate arbitrary classes.
+///
+/// @remarks    Values should conform to NSCoding protocol. Replicas trust the publisher, so place the socket
+///             into the directory which is not writable by other users, for example the app group container.
+///
+@interface POSLensPublisher : NSObject
+
+@property (nonatomic, readonly) POSLens *lens;
+@property (nonatomic, readonly) NSString *socketPath;
+
+///
+/// @brief      Creates publisher which listens for followers at the specified path.
+///
+/// @discussion Existing file at the socket path is removed. The method returns nil and `error`
+///             out parameter if the socket can't be created.
+///
++ (nullable instancetype)publisherWithLens:(POSLens *)lens
+                                socketPath:(NSString *)socketPath
+                                    logger:(nullable id<POSLogger>)logger
+                                     error:(NSError **)error;
+
+/// Disconnects followers and stops listening. Publisher does that automatically on deallocation.
+- (void)invalidate;
+
+POS_INIT_UNAVAILABLE
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,219 @@
+//
+//  POSLensPublisher.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensPublisher.h"
+#import "POSLensChange.h"
+#import "POSLensReplicationConnection.h"
+#import "NSError+POSLens.h"
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface POSLensPublisher ()
+@property (nonatomic, readonly, nullable) id<POSLogger> logger;
+@property (nonatomic, readonly) dispatch_queue_t queue;
+@property (nonatomic, readonly) dispatch_source_t acceptSource;
+@property (nonatomic, readonly) NSMutableArray<POSLensReplicationConnection *> *followers;
+@property (nonatomic, readonly) NSMutableArray<POSLensReplicationConnection *> *laggingFollowers;
+@property (nonatomic, readonly) RACDisposable *subscription;
+@property (nonatomic, nullable) POSLensValue *publishedValue;
+@property (nonatomic) uint64_t sequenceNumber;
+@end
+
+@implementation POSLensPublisher {
+    int _listeningSocket;
+}
+
+- (instancetype)initWithLens:(POSLens *)lens
+                  socketPath:(NSString *)socketPath
+             listeningSocket:(int)listeningSocket
+                      logger:(nullable id<POSLogger>)logger {
+    if (self = [super init]) {
+        _lens = lens;
+        _socketPath = [socketPath copy];
+        _logger = logger;
+        _listeningSocket = listeningSocket;
+        _queue = dispatch_queue_create("com.github.pavelosipov.POSLensPublisher", DISPATCH_QUEUE_SERIAL);
+        _followers = [NSMutableArray new];
+        _laggingFollowers = [NSMutableArray new];
+        _publishedValue = lens.value;
+        _acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, listeningSocket, 0, _queue);
+        NSString *path = _socketPath;
+        dispatch_source_set_cancel_handler(_acceptSource, ^{
+            close(listeningSocket);
+            unlink(path.fileSystemRepresentation);
+        });
+        @weakify(self);
+        dispatch_source_set_event_handler(_acceptSource, ^{
+            @strongify(self);
+            [self p_acceptFollowers];
+        });
+        dispatch_resume(_acceptSource);
+        _subscription = [lens.historicalValueUpdates subscribeNext:^(id _) {
+            @strongify(self);
+            if (self) {
+                dispatch_async(self.queue, ^{ [self p_publishActualValue]; });
+            }
+        }];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_subscription dispose];
+    dispatch_source_cancel(_acceptSource);
+}
+
++ (nullable instancetype)publisherWithLens:(POSLens *)lens
+                                socketPath:(NSString *)socketPath
+                                    logger:(nullable id<POSLogger>)logger
+                                     error:(NSError **)error {
+    POS_CHECK(lens);
+    struct sockaddr_un address;
+    if (!POSLensReplicationSocketAddress(socketPath, &address, error)) {
+        return nil;
+    }
+    int listeningSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listeningSocket < 0) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Failed to create socket: %s", strerror(errno)]);
+        return nil;
+    }
+    unlink(address.sun_path);
+    // Only processes of the same user may connect. Permissions are set before listen(), so
+    // nobody can connect to the socket while it has permissions from the umask.
+    if (bind(listeningSocket, (const struct sockaddr *)&address, sizeof(address)) != 0 ||
+        chmod(address.sun_path, S_IRUSR | S_IWUSR) != 0 ||
+        listen(listeningSocket, SOMAXCONN) != 0) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Failed to listen %@: %s", socketPath, strerror(errno)]);
+        close(listeningSocket);
+        return nil;
+    }
+    fcntl(listeningSocket, F_SETFL, fcntl(listeningSocket, F_GETFL) | O_NONBLOCK);
+    return [[self alloc] initWithLens:lens socketPath:socketPath listeningSocket:listeningSocket logger:logger];
+}
+
+#pragma mark - Public
+
+- (void)invalidate {
+    [_subscription dispose];
+    dispatch_async(_queue, ^{
+        dispatch_source_cancel(self.acceptSource);
+        for (POSLensReplicationConnection *follower in self.followers) {
+            [follower close];
+        }
+        [self.followers removeAllObjects];
+        [self.laggingFollowers removeAllObjects];
+    });
+}
+
+#pragma mark - Private
+
+- (void)p_acceptFollowers {
+    while (!dispatch_source_testcancel(_acceptSource)) {
+        int socket = accept(_listeningSocket, NULL, NULL);
+        if (socket < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                [_logger logError:@"Publisher<%@>: Failed to accept follower: %s", _socketPath, strerror(errno)];
+            }
+            return;
+        }
+        POSLensReplicationConnection *follower = [[POSLensReplicationConnection alloc]
+                                                  initWithSocket:socket
+                                                  queue:_queue
+                                                  pendingBytesLimit:POSLensReplicationDefaultPendingBytesLimit];
+        follower.allowedMessageClasses = [NSSet setWithObjects:NSDictionary.class, NSString.class, NSNumber.class, nil];
+        @weakify(self);
+        @weakify(follower);
+        follower.messageHandler = ^(NSDictionary<NSString *, id> *message) {
+            @strongify(self);
+            @strongify(follower);
+            if ([message[kPOSLensReplicationResyncKey] boolValue]) {
+                [self p_sendSnapshotToFollower:follower];
+            }
+        };
+        follower.closeHandler = ^(NSError * _Nullable error) {
+            @strongify(self);
+            @strongify(follower);
+            if (error) {
+                [self.logger logError:@"Publisher<%@>: Follower was disconnected: %@", self.socketPath, error];
+            }
+            [self.followers removeObjectIdenticalTo:follower];
+            [self.laggingFollowers removeObjectIdenticalTo:follower];
+        };
+        follower.drainHandler = ^{
+            @strongify(self);
+            @strongify(follower);
+            if ([self.laggingFollowers indexOfObjectIdenticalTo:follower] != NSNotFound) {
+                [self p_sendSnapshotToFollower:follower];
+            }
+        };
+        [_followers addObject:follower];
+        [follower resume];
+        [self p_sendSnapshotToFollower:follower];
+    }
+}
+
+- (void)p_sendSnapshotToFollower:(POSLensReplicationConnection *)follower {
+    [_laggingFollowers removeObjectIdenticalTo:follower];
+    NSError *error = nil;
+    NSData *frame = [POSLensReplicationConnection frameWithMessage:@{
+        kPOSLensReplicationSequenceKey: @(_sequenceNumber),
+        kPOSLensReplicationSnapshotKey: _publishedValue ?: [NSNull null]
+    } error:&error];
+    if (!frame) {
+        [_logger logError:@"Publisher<%@>: Failed to encode snapshot: %@", _socketPath, error];
+        return;
+    }
+    [follower sendFrame:frame force:YES];
+}
+
+- (void)p_publishActualValue {
+    POSLensValue *value = _lens.value;
+    if (value == _publishedValue) {
+        return;
+    }
+    NSArray<POSLensChange *> *changes = [POSLensChange changesFromValue:_publishedValue toValue:value];
+    self.publishedValue = value;
+    if (changes.count == 0) {
+        return;
+    }
+    self.sequenceNumber += 1;
+    if (_followers.count == 0) {
+        return;
+    }
+    NSError *error = nil;
+    NSData *frame = [POSLensReplicationConnection frameWithMessage:@{
+        kPOSLensReplicationSequenceKey: @(_sequenceNumber),
+        kPOSLensReplicationChangesKey: changes
+    } error:&error];
+    if (!frame) {
+        [_logger logError:@"Publisher<%@>: Failed to encode changes: %@", _socketPath, error];
+        return;
+    }
+    for (POSLensReplicationConnection *follower in [_followers copy]) {
+        if ([_laggingFollowers indexOfObjectIdenticalTo:follower] != NSNotFound) {
+            continue;
+        }
+        if (![follower sendFrame:frame force:NO]) {
+            // The follower gets the snapshot as soon as it reads pending messages,
+            // so it catches up even if there are no more updates.
+            [_laggingFollowers addObject:follower];
+            [_logger logInfo:@"Publisher<%@>: Dropped changes #%@ for slow follower.", _socketPath, @(_sequenceNumber)];
+        }
+    }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,47 @@
+//
+//  POSLensReplica.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLens.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///
+/// Read-only copy of the lens which is published by POSLensPublisher in another process.
+///
+/// @discussion Replica connects to the publisher's socket, receives the snapshot of the value and
+///             then applies published changes to it. If some message was lost, the replica requests
+///             a new snapshot and ignores changes until it arrives. If the publisher is not available,
+///             the replica keeps the last received value and reconnects periodically.
+///
+///             The lens of the replica emits notifications on the replica's private queue.
+///
+@interface POSLensReplica : NSObject
+
+/// Lens with the replicated value or the default value until the first snapshot is received.
+@property (nonatomic, readonly) POSLens *lens;
+
+@property (nonatomic, readonly) NSString *socketPath;
+
+///
+/// @brief      Creates replica which connects to the publisher at the specified path.
+///
+/// @discussion The method returns nil and `error` out parameter if the socket path is invalid.
+///
++ (nullable instancetype)replicaWithSocketPath:(NSString *)socketPath
+                                  defaultValue:(nullable POSLensValue *)defaultValue
+                                        logger:(nullable id<POSLogger>)logger
+                                         error:(NSError **)error;
+
+/// Disconnects from the publisher. The lens keeps the last received value.
+- (void)invalidate;
+
+POS_INIT_UNAVAILABLE
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,186 @@
+//
+//  POSLensReplica.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensReplica.h"
+#import "POSLensChange.h"
+#import "POSLensReplicationConnection.h"
+#import "POSEphemeralValueStore.h"
+#import "NSError+POSLens.h"
+#include <sys/socket.h>
+#include <unistd.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+static const NSTimeInterval kPOSLensReplicaReconnectInterval = 1.0;
+
+@interface POSLensReplica ()
+@property (nonatomic, readonly) POSMutableLens *mutableLens;
+@property (nonatomic, readonly, nullable) id<POSLogger> logger;
+@property (nonatomic, readonly) dispatch_queue_t queue;
+@property (nonatomic, nullable) POSLensReplicationConnection *connection;
+@property (nonatomic) uint64_t sequenceNumber;
+@property (nonatomic) BOOL awaitingSnapshot;
+@property (nonatomic) BOOL invalidated;
+@end
+
+@implementation POSLensReplica {
+    struct sockaddr_un _address;
+}
+
+- (instancetype)initWithSocketPath:(NSString *)socketPath
+                           address:(const struct sockaddr_un *)address
+                      defaultValue:(nullable POSLensValue *)defaultValue
+                            logger:(nullable id<POSLogger>)logger {
+    if (self = [super init]) {
+        _socketPath = [socketPath copy];
+        _address = *address;
+        _logger = logger;
+        _queue = dispatch_queue_create("com.github.pavelosipov.POSLensReplica", DISPATCH_QUEUE_SERIAL);
+        _mutableLens = [POSMutableLens
+                        lensWithDefaultValue:defaultValue
+                        store:[[POSEphemeralValueStore alloc] initWithValue:nil]
+                        logger:logger
+                        error:nil];
+        _awaitingSnapshot = YES;
+    }
+    return self;
+}
+
++ (nullable instancetype)replicaWithSocketPath:(NSString *)socketPath
+                                  defaultValue:(nullable POSLensValue *)defaultValue
+                                        logger:(nullable id<POSLogger>)logger
+                                         error:(NSError **)error {
+    struct sockaddr_un address;
+    if (!POSLensReplicationSocketAddress(socketPath, &address, error)) {
+        return nil;
+    }
+    POSLensReplica *replica = [[self alloc]
+                               initWithSocketPath:socketPath
+                               address:&address
+                               defaultValue:defaultValue
+                               logger:logger];
+    dispatch_async(replica.queue, ^{
+        [replica p_connect];
+    });
+    return replica;
+}
+
+#pragma mark - Public
+
+- (POSLens *)lens {
+    return _mutableLens;
+}
+
+- (void)invalidate {
+    dispatch_async(_queue, ^{
+        self.invalidated = YES;
+        [self.connection close];
+        self.connection = nil;
+    });
+}
+
+#pragma mark - Private
+
+- (void)p_connect {
+    if (_invalidated || _connection) {
+        return;
+    }
+    int socket = -1;
+    if ((socket = [self p_connectedSocket]) < 0) {
+        [self p_scheduleReconnect];
+        return;
+    }
+    POSLensReplicationConnection *connection = [[POSLensReplicationConnection alloc]
+                                                initWithSocket:socket
+                                                queue:_queue
+                                                pendingBytesLimit:POSLensReplicationDefaultPendingBytesLimit];
+    @weakify(self);
+    connection.messageHandler = ^(NSDictionary<NSString *, id> *message) {
+        @strongify(self);
+        [self p_handleMessage:message];
+    };
+    connection.closeHandler = ^(NSError * _Nullable error) {
+        @strongify(self);
+        [self.logger logInfo:@"Replica<%@>: Publisher was disconnected: %@", self.socketPath, error];
+        self.connection = nil;
+        [self p_scheduleReconnect];
+    };
+    self.connection = connection;
+    self.awaitingSnapshot = YES;
+    [connection resume];
+}
+
+- (int)p_connectedSocket {
+    int result = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (result < 0) {
+        [_logger logError:@"Replica<%@>: Failed to create socket: %s", _socketPath, strerror(errno)];
+        return -1;
+    }
+    if (connect(result, (const struct sockaddr *)&_address, sizeof(_address)) != 0) {
+        close(result);
+        return -1;
+    }
+    return result;
+}
+
+- (void)p_scheduleReconnect {
+    if (_invalidated) {
+        return;
+    }
+    @weakify(self);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kPOSLensReplicaReconnectInterval * NSEC_PER_SEC)),
+                   _queue, ^{
+        @strongify(self);
+        [self p_connect];
+    });
+}
+
+- (void)p_handleMessage:(NSDictionary<NSString *, id> *)message {
+    NSNumber *sequenceNumber = message[kPOSLensReplicationSequenceKey];
+    if (![sequenceNumber isKindOfClass:NSNumber.class]) {
+        [_logger logError:@"Replica<%@>: Message without sequence number.", _socketPath];
+        return;
+    }
+    id snapshot = message[kPOSLensReplicationSnapshotKey];
+    if (snapshot) {
+        [_mutableLens forceUpdateValue:(snapshot == [NSNull null] ? nil : snapshot)];
+        self.sequenceNumber = sequenceNumber.unsignedLongLongValue;
+        self.awaitingSnapshot = NO;
+        return;
+    }
+    if (_awaitingSnapshot) {
+        return;
+    }
+    NSArray<POSLensChange *> *changes = message[kPOSLensReplicationChangesKey];
+    if (sequenceNumber.unsignedLongLongValue != _sequenceNumber + 1 || ![changes isKindOfClass:NSArray.class]) {
+        [_logger logInfo:@"Replica<%@>: Gap after message #%@.", _socketPath, @(_sequenceNumber)];
+        [self p_requestSnapshot];
+        return;
+    }
+    NSError *error = nil;
+    BOOL applied = [_mutableLens updateValueWithBlock:^id _Nullable(id _Nullable value, NSError **error) {
+        return [POSLensChange valueByApplyingChanges:changes toValue:value error:error];
+    } error:&error];
+    if (!applied) {
+        [_logger logError:@"Replica<%@>: Failed to apply changes #%@: %@", _socketPath, sequenceNumber, error];
+        [self p_requestSnapshot];
+        return;
+    }
+    self.sequenceNumber = sequenceNumber.unsignedLongLongValue;
+}
+
+- (void)p_requestSnapshot {
+    self.awaitingSnapshot = YES;
+    NSData *frame = [POSLensReplicationConnection frameWithSecureMessage:@{kPOSLensReplicationResyncKey: @YES}
+                                                                          error:nil];
+    [_connection sendFrame:frame force:YES];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,99 @@
+//
+//  POSLensReplicationConnection.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#include <sys/un.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Sequence number of the published value (NSNumber).
+FOUNDATION_EXTERN NSString * const kPOSLensReplicationSequenceKey;
+/// Whole value of the lens or NSNull if the value is nil.
+FOUNDATION_EXTERN NSString * const kPOSLensReplicationSnapshotKey;
+/// Array of POSLensChange objects which transform previous value to the value with the message's sequence number.
+FOUNDATION_EXTERN NSString * const kPOSLensReplicationChangesKey;
+/// Replica's request for the snapshot.
+FOUNDATION_EXTERN NSString * const kPOSLensReplicationResyncKey;
+
+/// Max amount of bytes which publisher keeps in the outgoing buffer of the slow follower.
+FOUNDATION_EXTERN const NSUInteger POSLensReplicationDefaultPendingBytesLimit;
+
+///
+/// Fills Unix domain socket address.
+/// @returns NO and `error` out parameter if the path doesn't fit into the address.
+///
+FOUNDATION_EXTERN BOOL POSLensReplicationSocketAddress(NSString *socketPath,
+                                                       struct sockaddr_un *address,
+                                                       NSError **error);
+
+///
+/// Exchanges messages between POSLensPublisher and POSLensReplica through the nonblocking
+/// stream socket. Every message is a dictionary archived with NSKeyedArchiver and prefixed
+/// with its little-endian 32-bit length.
+///
+/// @remarks    All methods and handlers are invoked on the queue which was passed to the initializer.
+///
+@interface POSLensReplicationConnection : NSObject
+
+/// Called for each received message.
+@property (nonatomic, copy, nullable) void (^messageHandler)(NSDictionary<NSString *, id> *message);
+
+/// Called once when the connection was closed by the peer or because of the error.
+@property (nonatomic, copy, nullable) void (^closeHandler)(NSError * _Nullable error);
+
+/// Called when all enqueued frames were written to the socket.
+@property (nonatomic, copy, nullable) void (^drainHandler)(void);
+
+///
+/// @brief      Classes which received messages may consist of.
+///
+/// @discussion If the set is specified, then messages are decoded using NSSecureCoding and
+///             the connection is closed when the message contains objects of other classes.
+///             Otherwise the peer is trusted to send any NSCoding objects. Default is nil.
+///
+@property (nonatomic, copy, nullable) NSSet<Class> *allowedMessageClasses;
+
+///
+/// The designated initializer.
+/// @param socket          Connected socket. Connection owns it and closes it when it is closed.
+/// @param queue           Serial queue for I/O and handlers.
+/// @param pendingBytesLimit Max size of the outgoing buffer after which frames are dropped.
+///
+- (instancetype)initWithSocket:(int)socket
+                         queue:(dispatch_queue_t)queue
+             pendingBytesLimit:(NSUInteger)pendingBytesLimit;
+
+/// Archives message into the frame which may be sent through several connections.
++ (nullable NSData *)frameWithMessage:(NSDictionary<NSString *, id> *)message error:(NSError **)error;
+
+///
+/// Archives message into the frame using NSSecureCoding.
+/// @remarks Only such frames are accepted by the peer with allowedMessageClasses.
+///
++ (nullable NSData *)frameWithSecureMessage:(NSDictionary<NSString *, id<NSSecureCoding>> *)message
+                                      error:(NSError **)error;
+
+/// Starts receiving messages.
+- (void)resume;
+
+///
+/// @brief      Enqueues frame for sending.
+/// @param force Enqueues frame even if the outgoing buffer exceeded the limit.
+/// @returns    NO if the frame was dropped.
+///
+- (BOOL)sendFrame:(NSData *)frame force:(BOOL)force;
+
+/// Closes socket without calling close handler.
+- (void)close;
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,274 @@
+//
+//  POSLensReplicationConnection.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSLensReplicationConnection.h"
+#import "POSLens.h"
+#import "NSError+POSLens.h"
+#import "POSKeyedArchiving.h"
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+NSString * const kPOSLensReplicationSequenceKey = @"seq";
+NSString * const kPOSLensReplicationSnapshotKey = @"snapshot";
+NSString * const kPOSLensReplicationChangesKey = @"changes";
+NSString * const kPOSLensReplicationResyncKey = @"resync";
+
+const NSUInteger POSLensReplicationDefaultPendingBytesLimit = 1024 * 1024;
+
+static const uint32_t kPOSLensReplicationMaxFrameLength = 256 * 1024 * 1024;
+static const size_t kPOSLensReplicationReadBufferSize = 16 * 1024;
+
+BOOL POSLensReplicationSocketAddress(NSString *socketPath, struct sockaddr_un *address, NSError **error) {
+    POS_CHECK(socketPath);
+    POS_CHECK(address);
+    const char *path = socketPath.fileSystemRepresentation;
+    memset(address, 0, sizeof(*address));
+    if (strlen(path) >= sizeof(address->sun_path)) {
+        POSAssignError(error, [NSError pos_lensErrorWithFormat:
+                               @"Socket path is longer than %d bytes: %@", (int)sizeof(address->sun_path) - 1, socketPath]);
+        return NO;
+    }
+    address->sun_family = AF_UNIX;
+    strlcpy(address->sun_path, path, sizeof(address->sun_path));
+    return YES;
+}
+
+@implementation POSLensReplicationConnection {
+    int _socket;
+    NSUInteger _pendingBytesLimit;
+    dispatch_source_t _readSource;
+    dispatch_source_t _writeSource;
+    BOOL _readSourceResumed;
+    BOOL _writeSourceResumed;
+    BOOL _closed;
+    NSMutableData *_inbox;
+    NSMutableData *_outbox;
+    NSUInteger _outboxOffset;
+}
+
+- (instancetype)initWithSocket:(int)socket
+                         queue:(dispatch_queue_t)queue
+             pendingBytesLimit:(NSUInteger)pendingBytesLimit {
+    POS_CHECK(socket >= 0);
+    POS_CHECK(queue);
+    if (self = [super init]) {
+        _socket = socket;
+        _pendingBytesLimit = pendingBytesLimit;
+        _inbox = [NSMutableData new];
+        _outbox = [NSMutableData new];
+        fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+        int noSigPipe = 1;
+        setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+        _readSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, socket, 0, queue);
+        _writeSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_WRITE, socket, 0, queue);
+        // Socket may be closed only after both sources are cancelled.
+        dispatch_group_t cancellation = dispatch_group_create();
+        dispatch_group_enter(cancellation);
+        dispatch_group_enter(cancellation);
+        dispatch_source_set_cancel_handler(_readSource, ^{ dispatch_group_leave(cancellation); });
+        dispatch_source_set_cancel_handler(_writeSource, ^{ dispatch_group_leave(cancellation); });
+        dispatch_group_notify(cancellation, queue, ^{ close(socket); });
+        @weakify(self);
+        dispatch_source_set_event_handler(_readSource, ^{
+            @strongify(self);
+            [self p_readAvailableBytes];
+        });
+        dispatch_source_set_event_handler(_writeSource, ^{
+            @strongify(self);
+            [self p_flush];
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self close];
+}
+
+#pragma mark - Public
+
++ (nullable NSData *)frameWithMessage:(NSDictionary<NSString *, id> *)message error:(NSError **)error {
+    return [self p_frameWithMessage:message secure:NO error:error];
+}
+
++ (nullable NSData *)frameWithSecureMessage:(NSDictionary<NSString *, id<NSSecureCoding>> *)message
+                                      error:(NSError **)error {
+    return [self p_frameWithMessage:message secure:YES error:error];
+}
+
+- (void)resume {
+    if (!_closed && !_readSourceResumed) {
+        _readSourceResumed = YES;
+        dispatch_resume(_readSource);
+    }
+}
+
+- (BOOL)sendFrame:(NSData *)frame force:(BOOL)force {
+    POS_CHECK(frame);
+    if (_closed) {
+        return NO;
+    }
+    NSUInteger pendingBytes = _outbox.length - _outboxOffset;
+    if (!force && pendingBytes > 0 && pendingBytes + frame.length > _pendingBytesLimit) {
+        return NO;
+    }
+    [_outbox appendData:frame];
+    [self p_flush];
+    return YES;
+}
+
+- (void)close {
+    if (_closed) {
+        return;
+    }
+    _closed = YES;
+    _messageHandler = nil;
+    _closeHandler = nil;
+    _drainHandler = nil;
+    // Suspended sources should be resumed before cancellation, otherwise their cancel handlers never run.
+    if (!_readSourceResumed) {
+        _readSourceResumed = YES;
+        dispatch_resume(_readSource);
+    }
+    if (!_writeSourceResumed) {
+        _writeSourceResumed = YES;
+        dispatch_resume(_writeSource);
+    }
+    dispatch_source_cancel(_readSource);
+    dispatch_source_cancel(_writeSource);
+}
+
+#pragma mark - Private
+
++ (nullable NSData *)p_frameWithMessage:(NSDictionary<NSString *, id> *)message
+                                 secure:(BOOL)secure
+                                  error:(NSError **)error {
+    POS_CHECK(message);
+    NSData *payload = nil;
+    @try {
+        payload = (secure ? POSArchiveSecureObject(message) : POSArchiveObject(message));
+    } @catch (NSException *exception) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        return nil;
+    }
+    if (payload.length > kPOSLensReplicationMaxFrameLength) {
+        POSAssignError(error, [NSError pos_lensErrorWithFormat:@"Replication frame is too large: %@", @(payload.length)]);
+        return nil;
+    }
+    uint32_t length = CFSwapInt32HostToLittle((uint32_t)payload.length);
+    NSMutableData *frame = [NSMutableData dataWithCapacity:sizeof(length) + payload.length];
+    [frame appendBytes:&length length:sizeof(length)];
+    [frame appendData:payload];
+    return frame;
+}
+
+- (void)p_closeWithError:(nullable NSError *)error {
+    void (^closeHandler)(NSError * _Nullable) = _closeHandler;
+    [self close];
+    if (closeHandler) {
+        closeHandler(error);
+    }
+}
+
+- (void)p_readAvailableBytes {
+    uint8_t buffer[kPOSLensReplicationReadBufferSize];
+    while (!_closed) {
+        ssize_t count = read(_socket, buffer, sizeof(buffer));
+        if (count > 0) {
+            [_inbox appendBytes:buffer length:count];
+        } else if (count == 0) {
+            [self p_processInbox];
+            [self p_closeWithError:nil];
+            return;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            [self p_closeWithError:[NSError pos_systemErrorWithFormat:@"Socket read failed: %s", strerror(errno)]];
+            return;
+        }
+    }
+    [self p_processInbox];
+}
+
+- (void)p_processInbox {
+    NSUInteger offset = 0;
+    while (!_closed && _inbox.length - offset >= sizeof(uint32_t)) {
+        uint32_t length;
+        memcpy(&length, (const uint8_t *)_inbox.bytes + offset, sizeof(length));
+        length = CFSwapInt32LittleToHost(length);
+        if (length > kPOSLensReplicationMaxFrameLength) {
+            [self p_closeWithError:[NSError pos_lensErrorWithFormat:@"Replication frame is too large: %@", @(length)]];
+            return;
+        }
+        if (_inbox.length - offset - sizeof(length) < length) {
+            break;
+        }
+        NSData *payload = [_inbox subdataWithRange:NSMakeRange(offset + sizeof(length), length)];
+        offset += sizeof(length) + length;
+        id message = nil;
+        @try {
+            message = (_allowedMessageClasses
+                       ? POSUnarchiveObjectOfClasses(payload, _allowedMessageClasses)
+                       : POSUnarchiveObject(payload));
+        } @catch (NSException *exception) {
+            message = nil;
+        }
+        if (![message isKindOfClass:NSDictionary.class]) {
+            [self p_closeWithError:[NSError pos_lensErrorWithFormat:@"Malformed replication message."]];
+            return;
+        }
+        if (_messageHandler) {
+            _messageHandler(message);
+        }
+    }
+    if (!_closed) {
+        [_inbox replaceBytesInRange:NSMakeRange(0, offset) withBytes:NULL length:0];
+    }
+}
+
+- (void)p_flush {
+    while (!_closed && _outboxOffset < _outbox.length) {
+        ssize_t count = write(_socket, (const uint8_t *)_outbox.bytes + _outboxOffset, _outbox.length - _outboxOffset);
+        if (count >= 0) {
+            _outboxOffset += count;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (!_writeSourceResumed) {
+                _writeSourceResumed = YES;
+                dispatch_resume(_writeSource);
+            }
+            return;
+        } else {
+            [self p_closeWithError:[NSError pos_systemErrorWithFormat:@"Socket write failed: %s", strerror(errno)]];
+            return;
+        }
+    }
+    if (_closed) {
+        return;
+    }
+    BOOL drained = _outbox.length > 0;
+    _outbox.length = 0;
+    _outboxOffset = 0;
+    if (_writeSourceResumed) {
+        _writeSourceResumed = NO;
+        dispatch_suspend(_writeSource);
+    }
+    if (drained && _drainHandler) {
+        _drainHandler();
+    }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -11,23 +11,23 @@
 NS_ASSUME_NONNULL_BEGIN
 
 NS_INLINE BOOL POSObjectsAreEqual(id<NSObject> _Nullable l, id<NSObject> _Nullable r) {
-    return r == nil ? l == nil : [l isEqual:r];
+    return l == r || (r != nil && [l isEqual:r]);
 }
 
 NS_INLINE BOOL POSStringsAreEqual(NSString * _Nullable l, NSString * _Nullable r) {
-    return r == nil ? l == nil : [l isEqualToString:r];
+    return l == r || (r != nil && [l isEqualToString:r]);
 }
 
 NS_INLINE BOOL POSArraysAreEqual(NSArray * _Nullable l, NSArray * _Nullable r) {
-    return r == nil ? l == nil : [l isEqualToArray:r];
+    return l == r || (r != nil && [l isEqualToArray:r]);
 }
 
 NS_INLINE BOOL POSDictionariesAreEqual(NSDictionary * _Nullable l, NSDictionary * _Nullable r) {
-    return r == nil ? l == nil : [l isEqualToDictionary:r];
+    return l == r || (r != nil && [l isEqualToDictionary:r]);
 }
 
 NS_INLINE BOOL POSOrderedSetsAreEqual(NSOrderedSet * _Nullable l, NSOrderedSet * _Nullable r) {
-    return r == nil ? l == nil : [l isEqualToOrderedSet:r];
+    return l == r || (r != nil && [l isEqualToOrderedSet:r]);
 }
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,122 @@
+//
+//  POSFileIO.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Default size of the buffers which are used by file readers and writers.
+FOUNDATION_EXTERN const NSUInteger POSFileIODefaultBufferSize;
+
+/// Destination of the sequentially written bytes.
+@protocol POSByteSink <NSObject>
+
+- (BOOL)writeBytes:(const void *)bytes length:(NSUInteger)length error:(NSError **)error;
+- (BOOL)writeData:(NSData *)data error:(NSError **)error;
+
+@end
+
+/// Source of the sequentially read bytes.
+@protocol POSByteSource <NSObject>
+
+/// Reads exactly length bytes. Premature end of the stream is treated as an error.
+- (BOOL)readBytes:(void *)bytes length:(NSUInteger)length error:(NSError **)error;
+
+/// Reads exactly length bytes. Premature end of the stream is treated as an error.
+- (nullable NSData *)readDataOfLength:(NSUInteger)length error:(NSError **)error;
+
+@end
+
+#pragma mark -
+
+///
+/// Writes data into a temporary file through the bounded buffer and
+/// atomically replaces destination file with it on commit.
+///
+@interface POSAtomicFileWriter : NSObject <POSByteSink>
+
+@property (nonatomic, readonly) NSString *filePath;
+
+/// The convenience initializer with the default buffer size.
+- (instancetype)initWithFilePath:(NSString *)filePath;
+
+///
+/// The designated initializer.
+/// @param filePath   Path to the destination file.
+/// @param bufferSize Max amount of bytes which will be kept in memory before writing them to the file.
+///
+- (instancetype)initWithFilePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize;
+
+///
+/// Creates temporary file near the destination file. The file gets the mode of the existing destination
+/// file or the default mode for new files, so the replaced file keeps its permissions.
+///
+- (BOOL)open:(NSError **)error;
+
+/// Appends bytes to the temporary file.
+- (BOOL)writeBytes:(const void *)bytes length:(NSUInteger)length error:(NSError **)error;
+
+/// Appends data to the temporary file.
+- (BOOL)writeData:(NSData *)data error:(NSError **)error;
+
+///
+/// @brief      Flushes buffer, synchronizes temporary file with the disk and renames it to the destination path.
+/// @discussion Temporary file is removed in case of error. The parent directory is synchronized after
+///             the rename, so NO may also mean that the file was replaced but the rename is not durable yet.
+///
+- (BOOL)commit:(NSError **)error;
+
+/// Removes temporary file. Writer aborts automatically if it is deallocated without commit.
+- (void)abort;
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+@end
+
+#pragma mark -
+
+///
+/// Reads file sequentially through the bounded buffer.
+///
+@interface POSFileReader : NSObject <POSByteSource>
+
+@property (nonatomic, readonly) NSString *filePath;
+
+/// The size of the file. It is available after successful opening.
+@property (nonatomic, readonly) unsigned long long fileSize;
+
+/// The convenience initializer with the default buffer size.
+- (instancetype)initWithFilePath:(NSString *)filePath;
+
+/// The designated initializer.
+- (instancetype)initWithFilePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize;
+
+- (BOOL)open:(NSError **)error;
+
+///
+/// @brief   Reads up to length bytes from the file.
+/// @returns Number of read bytes, 0 at the end of file or -1 in case of error.
+///
+- (NSInteger)readBytes:(void *)bytes maxLength:(NSUInteger)length error:(NSError **)error;
+
+/// Reads exactly length bytes. Premature end of file is treated as an error.
+- (BOOL)readBytes:(void *)bytes length:(NSUInteger)length error:(NSError **)error;
+
+/// Reads exactly length bytes. Premature end of file is treated as an error.
+- (nullable NSData *)readDataOfLength:(NSUInteger)length error:(NSError **)error;
+
+/// Closes the file. Reader closes file automatically on deallocation.
+- (void)close;
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
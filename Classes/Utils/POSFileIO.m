@@ -0,0 +1,322 @@
+//
+//  POSFileIO.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSFileIO.h"
+#import "NSError+POSLens.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+const NSUInteger POSFileIODefaultBufferSize = 64 * 1024;
+
+static NSError *POSFileErrorWithErrno(NSString *filePath, int code) {
+    return [NSError pos_fileErrorWithPath:filePath reason:[NSError errorWithDomain:NSPOSIXErrorDomain
+                                                                              code:code
+                                                                          userInfo:nil]];
+}
+
+@interface POSAtomicFileWriter ()
+@property (nonatomic, readonly) NSUInteger bufferSize;
+@property (nonatomic, nullable) NSString *temporaryFilePath;
+@end
+
+@implementation POSAtomicFileWriter {
+    int _fd;
+    uint8_t *_buffer;
+    NSUInteger _bufferLength;
+}
+
+- (instancetype)initWithFilePath:(NSString *)filePath {
+    return [self initWithFilePath:filePath bufferSize:POSFileIODefaultBufferSize];
+}
+
+- (instancetype)initWithFilePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize {
+    POS_CHECK(filePath);
+    POS_CHECK(bufferSize > 0);
+    if (self = [super init]) {
+        _filePath = [filePath copy];
+        _bufferSize = bufferSize;
+        _fd = -1;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self abort];
+}
+
+#pragma mark - Public
+
+- (BOOL)open:(NSError **)error {
+    POS_CHECK(_fd < 0);
+    NSString *temporaryFilePath = [_filePath stringByAppendingFormat:@".%@", [NSUUID UUID].UUIDString];
+    // Unlike mkstemp, which always uses 0600 mode, open applies the umask to the default mode of new files.
+    int fd = open(temporaryFilePath.fileSystemRepresentation, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        POSAssignError(error, POSFileErrorWithErrno(_filePath, errno));
+        return NO;
+    }
+    struct stat destination;
+    if (stat(_filePath.fileSystemRepresentation, &destination) == 0 && fchmod(fd, destination.st_mode & 07777) != 0) {
+        POSAssignError(error, POSFileErrorWithErrno(temporaryFilePath, errno));
+        close(fd);
+        unlink(temporaryFilePath.fileSystemRepresentation);
+        return NO;
+    }
+    _fd = fd;
+    _temporaryFilePath = temporaryFilePath;
+    _buffer = malloc(_bufferSize);
+    _bufferLength = 0;
+    return YES;
+}
+
+- (BOOL)writeBytes:(const void *)bytes length:(NSUInteger)length error:(NSError **)error {
+    POS_CHECK(_fd >= 0);
+    if (_bufferLength + length <= _bufferSize) {
+        memcpy(_buffer + _bufferLength, bytes, length);
+        _bufferLength += length;
+        return YES;
+    }
+    if (![self p_flush:error]) {
+        return NO;
+    }
+    if (length >= _bufferSize) {
+        return [self p_writeBytes:bytes length:length error:error];
+    }
+    memcpy(_buffer, bytes, length);
+    _bufferLength = length;
+    return YES;
+}
+
+- (BOOL)writeData:(NSData *)data error:(NSError **)error {
+    return [self writeBytes:data.bytes length:data.length error:error];
+}
+
+- (BOOL)commit:(NSError **)error {
+    POS_CHECK(_fd >= 0);
+    if (![self p_flush:error]) {
+        [self abort];
+        return NO;
+    }
+    int syncError = fsync(_fd) != 0 ? errno : 0;
+    int closeError = close(_fd) != 0 ? errno : 0;
+    _fd = -1;
+    if (syncError != 0 || closeError != 0) {
+        POSAssignError(error, POSFileErrorWithErrno(_temporaryFilePath, syncError ?: closeError));
+        [self abort];
+        return NO;
+    }
+    if (rename(_temporaryFilePath.fileSystemRepresentation, _filePath.fileSystemRepresentation) != 0) {
+        POSAssignError(error, POSFileErrorWithErrno(_filePath, errno));
+        [self abort];
+        return NO;
+    }
+    _temporaryFilePath = nil;
+    [self p_releaseBuffer];
+    return [self p_syncDirectory:error];
+}
+
+- (void)abort {
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+    if (_temporaryFilePath) {
+        unlink(_temporaryFilePath.fileSystemRepresentation);
+        _temporaryFilePath = nil;
+    }
+    [self p_releaseBuffer];
+}
+
+#pragma mark - Private
+
+- (BOOL)p_flush:(NSError **)error {
+    if (_bufferLength == 0) {
+        return YES;
+    }
+    BOOL written = [self p_writeBytes:_buffer length:_bufferLength error:error];
+    _bufferLength = 0;
+    return written;
+}
+
+- (BOOL)p_writeBytes:(const uint8_t *)bytes length:(NSUInteger)length error:(NSError **)error {
+    while (length > 0) {
+        ssize_t written = write(_fd, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            POSAssignError(error, POSFileErrorWithErrno(_temporaryFilePath, errno));
+            return NO;
+        }
+        bytes += written;
+        length -= (NSUInteger)written;
+    }
+    return YES;
+}
+
+/// Makes the rename durable. Without it the directory entry may be lost on power failure.
+- (BOOL)p_syncDirectory:(NSError **)error {
+    NSString *directoryPath = [_filePath stringByDeletingLastPathComponent];
+    if (directoryPath.length == 0) {
+        directoryPath = @".";
+    }
+    int fd = open(directoryPath.fileSystemRepresentation, O_RDONLY);
+    if (fd < 0) {
+        POSAssignError(error, POSFileErrorWithErrno(directoryPath, errno));
+        return NO;
+    }
+    int syncError = fsync(fd) != 0 ? errno : 0;
+    close(fd);
+    if (syncError != 0) {
+        POSAssignError(error, POSFileErrorWithErrno(directoryPath, syncError));
+        return NO;
+    }
+    return YES;
+}
+
+- (void)p_releaseBuffer {
+    free(_buffer);
+    _buffer = NULL;
+    _bufferLength = 0;
+}
+
+@end
+
+#pragma mark -
+
+@interface POSFileReader ()
+@property (nonatomic, readonly) NSUInteger bufferSize;
+@end
+
+@implementation POSFileReader {
+    int _fd;
+    uint8_t *_buffer;
+    NSUInteger _bufferOffset;
+    NSUInteger _bufferLength;
+}
+
+- (instancetype)initWithFilePath:(NSString *)filePath {
+    return [self initWithFilePath:filePath bufferSize:POSFileIODefaultBufferSize];
+}
+
+- (instancetype)initWithFilePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize {
+    POS_CHECK(filePath);
+    POS_CHECK(bufferSize > 0);
+    if (self = [super init]) {
+        _filePath = [filePath copy];
+        _bufferSize = bufferSize;
+        _fd = -1;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self close];
+}
+
+#pragma mark - Public
+
+- (BOOL)open:(NSError **)error {
+    POS_CHECK(_fd < 0);
+    _fd = open(_filePath.fileSystemRepresentation, O_RDONLY);
+    if (_fd < 0) {
+        POSAssignError(error, POSFileErrorWithErrno(_filePath, errno));
+        return NO;
+    }
+    struct stat info;
+    if (fstat(_fd, &info) != 0) {
+        POSAssignError(error, POSFileErrorWithErrno(_filePath, errno));
+        [self close];
+        return NO;
+    }
+    _fileSize = (unsigned long long)info.st_size;
+    _buffer = malloc(_bufferSize);
+    _bufferOffset = 0;
+    _bufferLength = 0;
+    return YES;
+}
+
+- (NSInteger)readBytes:(void *)bytes maxLength:(NSUInteger)length error:(NSError **)error {
+    POS_CHECK(_fd >= 0);
+    if (length == 0) {
+        return 0;
+    }
+    if (_bufferOffset == _bufferLength) {
+        if (length >= _bufferSize) {
+            return [self p_readBytes:bytes maxLength:length error:error];
+        }
+        NSInteger count = [self p_readBytes:_buffer maxLength:_bufferSize error:error];
+        if (count <= 0) {
+            return count;
+        }
+        _bufferOffset = 0;
+        _bufferLength = (NSUInteger)count;
+    }
+    NSUInteger count = MIN(length, _bufferLength - _bufferOffset);
+    memcpy(bytes, _buffer + _bufferOffset, count);
+    _bufferOffset += count;
+    return (NSInteger)count;
+}
+
+- (BOOL)readBytes:(void *)bytes length:(NSUInteger)length error:(NSError **)error {
+    uint8_t *cursor = bytes;
+    while (length > 0) {
+        NSInteger count = [self readBytes:cursor maxLength:length error:error];
+        if (count < 0) {
+            return NO;
+        }
+        if (count == 0) {
+            POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Unexpected end of file %@", _filePath]);
+            return NO;
+        }
+        cursor += count;
+        length -= (NSUInteger)count;
+    }
+    return YES;
+}
+
+- (nullable NSData *)readDataOfLength:(NSUInteger)length error:(NSError **)error {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    if (![self readBytes:data.mutableBytes length:length error:error]) {
+        return nil;
+    }
+    return data;
+}
+
+- (void)close {
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+    free(_buffer);
+    _buffer = NULL;
+    _bufferOffset = 0;
+    _bufferLength = 0;
+}
+
+#pragma mark - Private
+
+- (NSInteger)p_readBytes:(void *)bytes maxLength:(NSUInteger)length error:(NSError **)error {
+    while (YES) {
+        ssize_t count = read(_fd, bytes, length);
+        if (count >= 0) {
+            return count;
+        }
+        if (errno != EINTR) {
+            POSAssignError(error, POSFileErrorWithErrno(_filePath, errno));
+            return -1;
+        }
+    }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,34 @@
+//
+//  POSKeyedArchiving.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// YES if the value is a dictionary with string keys. Stores and replication decompose such dictionaries by keys.
+FOUNDATION_EXTERN BOOL POSIsStringKeyedDictionary(id _Nullable value);
+
+/// Archives the object graph in the binary format. Throws NSException if some object can't be encoded.
+FOUNDATION_EXTERN NSData *POSArchiveObject(id object);
+
+/// Unarchives the object graph. Throws NSException if the data is malformed.
+FOUNDATION_EXTERN id _Nullable POSUnarchiveObject(NSData *data);
+
+///
+/// Archives the object graph using NSSecureCoding for POSUnarchiveObjectOfClasses.
+/// Throws NSException if some object doesn't support secure coding.
+///
+FOUNDATION_EXTERN NSData *POSArchiveSecureObject(id<NSSecureCoding> object);
+
+///
+/// Unarchives the object graph archived by POSArchiveSecureObject from the untrusted source.
+/// Throws NSException if the data is malformed or contains objects of other classes.
+///
+FOUNDATION_EXTERN id _Nullable POSUnarchiveObjectOfClasses(NSData *data, NSSet<Class> *classes);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,59 @@
+//
+//  POSKeyedArchiving.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSKeyedArchiving.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// NSKeyedArchiveRootObjectKey is not available on iOS 8.
+static NSString * const kPOSSecureArchiveRootKey = @"root";
+
+BOOL POSIsStringKeyedDictionary(id _Nullable value) {
+    if (![value isKindOfClass:NSDictionary.class]) {
+        return NO;
+    }
+    for (id key in (NSDictionary *)value) {
+        if (![key isKindOfClass:NSString.class]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+NSData *POSArchiveObject(id object) {
+    NSMutableData *data = [NSMutableData data];
+    NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+    [archiver setOutputFormat:NSPropertyListBinaryFormat_v1_0];
+    [archiver encodeRootObject:object];
+    [archiver finishEncoding];
+    return data;
+}
+
+NSData *POSArchiveSecureObject(id<NSSecureCoding> object) {
+    NSMutableData *data = [NSMutableData data];
+    NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+    archiver.requiresSecureCoding = YES;
+    [archiver setOutputFormat:NSPropertyListBinaryFormat_v1_0];
+    [archiver encodeObject:object forKey:kPOSSecureArchiveRootKey];
+    [archiver finishEncoding];
+    return data;
+}
+
+id _Nullable POSUnarchiveObject(NSData *data) {
+    return [[[NSKeyedUnarchiver alloc] initForReadingWithData:data] decodeObject];
+}
+
+id _Nullable POSUnarchiveObjectOfClasses(NSData *data, NSSet<Class> *classes) {
+    NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+    unarchiver.requiresSecureCoding = YES;
+    id object = [unarchiver decodeObjectOfClasses:classes forKey:kPOSSecureArchiveRootKey];
+    [unarchiver finishDecoding];
+    return object;
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,197 @@
+//
+//  POSLZ4.c
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#include "POSLZ4.h"
+#include <string.h>
+
+#define POS_LZ4_MIN_MATCH 4
+#define POS_LZ4_LAST_LITERALS 5
+#define POS_LZ4_MATCH_FIND_LIMIT 12
+#define POS_LZ4_MAX_OFFSET 65535
+#define POS_LZ4_HASH_LOG 12
+#define POS_LZ4_SKIP_TRIGGER 6
+#define POS_LZ4_MAX_INPUT_SIZE 0x7E000000
+
+static inline uint32_t POSLZ4Read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t POSLZ4Hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - POS_LZ4_HASH_LOG);
+}
+
+static inline uint8_t *POSLZ4WriteLength(uint8_t *op, size_t length) {
+    for (; length >= 255; length -= 255) {
+        *op++ = 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+size_t POSLZ4CompressBound(size_t sourceSize) {
+    return sourceSize > POS_LZ4_MAX_INPUT_SIZE ? 0 : sourceSize + sourceSize / 255 + 16;
+}
+
+size_t POSLZ4Compress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationCapacity) {
+    const uint8_t *ip = source;
+    const uint8_t *anchor = source;
+    const uint8_t *const iend = source + sourceSize;
+    uint8_t *op = destination;
+    uint8_t *const oend = destination + destinationCapacity;
+    if (sourceSize > POS_LZ4_MAX_INPUT_SIZE) {
+        return 0;
+    }
+    if (sourceSize > POS_LZ4_MATCH_FIND_LIMIT) {
+        const uint8_t *const mflimit = iend - POS_LZ4_MATCH_FIND_LIMIT;
+        const uint8_t *const matchlimit = iend - POS_LZ4_LAST_LITERALS;
+        uint32_t table[1 << POS_LZ4_HASH_LOG];
+        memset(table, 0, sizeof(table));
+        ip++;
+        while (ip < mflimit) {
+            // Search for the match, speeding up on incompressible data.
+            const uint8_t *match = NULL;
+            unsigned attempts = 1 << POS_LZ4_SKIP_TRIGGER;
+            while (ip < mflimit) {
+                uint32_t sequence = POSLZ4Read32(ip);
+                uint32_t h = POSLZ4Hash(sequence);
+                const uint8_t *candidate = source + table[h];
+                table[h] = (uint32_t)(ip - source);
+                if (candidate < ip && ip - candidate <= POS_LZ4_MAX_OFFSET && POSLZ4Read32(candidate) == sequence) {
+                    match = candidate;
+                    break;
+                }
+                ip += attempts++ >> POS_LZ4_SKIP_TRIGGER;
+            }
+            if (match == NULL) {
+                break;
+            }
+            // Extend the match backward and forward.
+            while (ip > anchor && match > source && ip[-1] == match[-1]) {
+                --ip;
+                --match;
+            }
+            const uint8_t *matchEnd = ip + POS_LZ4_MIN_MATCH;
+            const uint8_t *reference = match + POS_LZ4_MIN_MATCH;
+            while (matchEnd < matchlimit && *matchEnd == *reference) {
+                ++matchEnd;
+                ++reference;
+            }
+            size_t literalLength = (size_t)(ip - anchor);
+            size_t matchLength = (size_t)(matchEnd - ip) - POS_LZ4_MIN_MATCH;
+            if ((size_t)(oend - op) < 1 + literalLength + literalLength / 255 + 1 + 2 + matchLength / 255 + 1) {
+                return 0;
+            }
+            // Emit the sequence.
+            uint8_t *token = op++;
+            if (literalLength >= 15) {
+                *token = 15 << 4;
+                op = POSLZ4WriteLength(op, literalLength - 15);
+            } else {
+                *token = (uint8_t)(literalLength << 4);
+            }
+            memcpy(op, anchor, literalLength);
+            op += literalLength;
+            uint16_t offset = (uint16_t)(ip - match);
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            if (matchLength >= 15) {
+                *token |= 15;
+                op = POSLZ4WriteLength(op, matchLength - 15);
+            } else {
+                *token |= (uint8_t)matchLength;
+            }
+            ip = matchEnd;
+            anchor = ip;
+            if (ip < mflimit) {
+                table[POSLZ4Hash(POSLZ4Read32(ip - 2))] = (uint32_t)(ip - 2 - source);
+            }
+        }
+    }
+    // The last sequence contains literals only.
+    size_t literalLength = (size_t)(iend - anchor);
+    if ((size_t)(oend - op) < 1 + literalLength + literalLength / 255 + 1) {
+        return 0;
+    }
+    if (literalLength >= 15) {
+        *op++ = 15 << 4;
+        op = POSLZ4WriteLength(op, literalLength - 15);
+    } else {
+        *op++ = (uint8_t)(literalLength << 4);
+    }
+    memcpy(op, anchor, literalLength);
+    op += literalLength;
+    return (size_t)(op - destination);
+}
+
+long POSLZ4Decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationCapacity) {
+    const uint8_t *ip = source;
+    const uint8_t *const iend = source + sourceSize;
+    uint8_t *op = destination;
+    uint8_t *const oend = destination + destinationCapacity;
+    if (sourceSize == 0) {
+        return -1;
+    }
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            uint8_t next;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                next = *ip++;
+                literalLength += next;
+            } while (next == 255);
+        }
+        if (literalLength > (size_t)(iend - ip) || literalLength > (size_t)(oend - op)) {
+            return -1;
+        }
+        memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+        if (ip == iend) {
+            break;
+        }
+        if (iend - ip < 2) {
+            return -1;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - destination)) {
+            return -1;
+        }
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            uint8_t next;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                next = *ip++;
+                matchLength += next;
+            } while (next == 255);
+        }
+        matchLength += POS_LZ4_MIN_MATCH;
+        if (matchLength > (size_t)(oend - op)) {
+            return -1;
+        }
+        const uint8_t *match = op - offset;
+        if (offset >= matchLength) {
+            memcpy(op, match, matchLength);
+            op += matchLength;
+        } else {
+            for (size_t i = 0; i < matchLength; ++i) {
+                *op++ = *match++;
+            }
+        }
+    }
+    return (long)(op - destination);
+}
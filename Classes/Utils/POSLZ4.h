@@ -0,0 +1,43 @@
+//
+//  POSLZ4.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#ifndef POSLZ4_h
+#define POSLZ4_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+///
+/// Compact implementation of the LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+/// Compressed blocks are compatible with the reference LZ4_decompress_safe function and vice versa.
+///
+
+/// Max size of the compressed block for the input of specified size or 0 if the input is too large.
+size_t POSLZ4CompressBound(size_t sourceSize);
+
+///
+/// Compresses source buffer into destination buffer using greedy single-pass matching.
+/// @returns Size of the compressed block or 0 if destination buffer is too small.
+///
+size_t POSLZ4Compress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationCapacity);
+
+///
+/// Decompresses block into destination buffer. The function never reads or writes out of the buffers' bounds.
+/// @returns Size of the decompressed data or -1 if block is malformed or destination buffer is too small.
+///
+long POSLZ4Decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationCapacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POSLZ4_h */
@@ -0,0 +1,60 @@
+//
+//  POSEncryptedFileValueStore.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSStreamingFileValueStore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The size of the key for POSEncryptedFileValueStore in bytes.
+FOUNDATION_EXTERN const NSUInteger POSEncryptedFileValueStoreKeySize;
+
+///
+/// Streaming file value store which encrypts and authenticates the file with the key supplied by the caller.
+///
+/// @discussion The stream of frames is split into chunks. Every chunk is encrypted with AES-256 in CTR mode
+///             and authenticated with HMAC-SHA256 before it goes to the file, so the value is never kept in
+///             memory as a whole neither in plain nor in encrypted form. Encryption and authentication keys
+///             are derived from the caller's key and a random nonce which is generated on every save.
+///             The tag of the chunk covers the file header, the index of the chunk and the flag of the last
+///             chunk, so reordered, truncated or extended files are rejected. Chunks are verified before
+///             their content is decoded. AES is hardware accelerated on all supported devices.
+///
+///             The scheme is encrypt-then-MAC with AES-CTR and HMAC-SHA256, not an AEAD mode like AES-GCM.
+///             The whole chunk is hashed in addition to encryption, so saves and loads are slower than
+///             with POSStreamingFileValueStore.
+///
+/// @remarks    The store never loads unencrypted files. Keep the key out of the file system,
+///             for example in the keychain. The store uses CommonCrypto and Security frameworks,
+///             so it is available only on Apple platforms and not on Linux.
+///
+@interface POSEncryptedFileValueStore : POSStreamingFileValueStore
+
+///
+/// The convenience initializer with the default chunk size.
+/// @param filePath Path to the file with encrypted value.
+/// @param key      POSEncryptedFileValueStoreKeySize bytes of the secret key.
+///
+- (instancetype)initWithFilePath:(NSString *)filePath key:(NSData *)key;
+
+///
+/// The designated initializer.
+/// @param filePath  Path to the file with encrypted value.
+/// @param key       POSEncryptedFileValueStoreKeySize bytes of the secret key.
+/// @param chunkSize Max amount of plain bytes in the single encrypted chunk.
+///
+- (instancetype)initWithFilePath:(NSString *)filePath key:(NSData *)key chunkSize:(NSUInteger)chunkSize;
+
+/// Generates random key of POSEncryptedFileValueStoreKeySize bytes.
++ (nullable NSData *)generateKey:(NSError **)error;
+
+- (instancetype)initWithFilePath:(NSString *)filePath NS_UNAVAILABLE;
+- (instancetype)initWithFilePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
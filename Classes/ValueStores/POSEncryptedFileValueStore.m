@@ -0,0 +1,449 @@
+//
+//  POSEncryptedFileValueStore.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSEncryptedFileValueStore.h"
+#import "POSFileIO.h"
+#import "NSError+POSLens.h"
+#import <CommonCrypto/CommonCryptor.h>
+#import <CommonCrypto/CommonHMAC.h>
+#import <Security/SecRandom.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+const NSUInteger POSEncryptedFileValueStoreKeySize = kCCKeySizeAES256;
+
+static const uint8_t kPOSEncryptedMagic[8] = {'P', 'O', 'S', 'L', 'E', 'N', 'C', 1};
+static const NSUInteger kPOSEncryptedNonceSize = 16;
+static const NSUInteger kPOSEncryptedTagSize = CC_SHA256_DIGEST_LENGTH;
+static const NSUInteger kPOSEncryptedMaxChunkSize = 16 * 1024 * 1024;
+
+typedef NS_OPTIONS(uint8_t, POSEncryptedChunkFlags) {
+    POSEncryptedChunkFlagsNone = 0,
+    POSEncryptedChunkFlagsLast = 1 << 0
+};
+
+static void POSSecureZero(void *bytes, size_t length) {
+    volatile uint8_t *p = bytes;
+    while (length--) {
+        *p++ = 0;
+    }
+}
+
+static BOOL POSConstantTimeEqual(const uint8_t *l, const uint8_t *r, size_t length) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < length; ++i) {
+        diff |= l[i] ^ r[i];
+    }
+    return diff == 0;
+}
+
+static NSMutableData *POSDeriveKey(NSData *key, const char *label, NSData *header) {
+    CCHmacContext context;
+    CCHmacInit(&context, kCCHmacAlgSHA256, key.bytes, key.length);
+    CCHmacUpdate(&context, label, strlen(label) + 1);
+    CCHmacUpdate(&context, header.bytes, header.length);
+    NSMutableData *derivedKey = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+    CCHmacFinal(&context, derivedKey.mutableBytes);
+    return derivedKey;
+}
+
+#pragma mark -
+
+/// Encrypts and authenticates chunks of the stream. The ciphers are shared by the writer and the reader.
+@interface POSEncryptedChunkCipher : NSObject
+@property (nonatomic, readonly) NSUInteger chunkSize;
+@end
+
+@implementation POSEncryptedChunkCipher {
+    CCCryptorRef _cryptor;
+    NSData *_header;
+    NSMutableData *_macKey;
+    uint64_t _chunkIndex;
+}
+
+- (nullable instancetype)initWithOperation:(CCOperation)operation
+                                       key:(NSData *)key
+                                    header:(NSData *)header
+                                 chunkSize:(NSUInteger)chunkSize
+                                     error:(NSError **)error {
+    if (self = [super init]) {
+        _header = [header copy];
+        _chunkSize = chunkSize;
+        _macKey = POSDeriveKey(key, "POSLens.mac", header);
+        NSMutableData *encryptionKey = POSDeriveKey(key, "POSLens.enc", header);
+        uint8_t iv[kCCBlockSizeAES128] = {0};
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+        CCCryptorStatus status = CCCryptorCreateWithMode(operation, kCCModeCTR, kCCAlgorithmAES, ccNoPadding,
+                                                         iv, encryptionKey.bytes, encryptionKey.length,
+                                                         NULL, 0, 0, kCCModeOptionCTR_BE, &_cryptor);
+#pragma clang diagnostic pop
+        POSSecureZero(encryptionKey.mutableBytes, encryptionKey.length);
+        if (status != kCCSuccess) {
+            POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Failed to create cryptor: %@", @(status)]);
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    POSSecureZero(_macKey.mutableBytes, _macKey.length);
+    if (_cryptor) {
+        CCCryptorRelease(_cryptor);
+    }
+}
+
+- (BOOL)transformBytes:(const void *)input length:(NSUInteger)length output:(void *)output error:(NSError **)error {
+    size_t moved = 0;
+    CCCryptorStatus status = CCCryptorUpdate(_cryptor, input, length, output, length, &moved);
+    if (status != kCCSuccess || moved != length) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Failed to transform chunk: %@", @(status)]);
+        return NO;
+    }
+    return YES;
+}
+
+- (void)computeTag:(uint8_t *)tag
+      ofCiphertext:(const void *)ciphertext
+            length:(uint32_t)length
+             flags:(POSEncryptedChunkFlags)flags {
+    uint64_t chunkIndex = CFSwapInt64HostToLittle(_chunkIndex);
+    uint32_t chunkLength = CFSwapInt32HostToLittle(length);
+    CCHmacContext context;
+    CCHmacInit(&context, kCCHmacAlgSHA256, _macKey.bytes, _macKey.length);
+    CCHmacUpdate(&context, _header.bytes, _header.length);
+    CCHmacUpdate(&context, &chunkIndex, sizeof(chunkIndex));
+    CCHmacUpdate(&context, &flags, sizeof(flags));
+    CCHmacUpdate(&context, &chunkLength, sizeof(chunkLength));
+    CCHmacUpdate(&context, ciphertext, length);
+    CCHmacFinal(&context, tag);
+}
+
+- (void)advance {
+    ++_chunkIndex;
+}
+
+@end
+
+#pragma mark -
+
+/// Accumulates plain bytes and writes them to the file as encrypted chunks.
+@interface POSEncryptingSink : NSObject <POSByteSink>
+@end
+
+@implementation POSEncryptingSink {
+    POSAtomicFileWriter *_writer;
+    POSEncryptedChunkCipher *_cipher;
+    uint8_t *_plaintext;
+    uint8_t *_ciphertext;
+    NSUInteger _length;
+}
+
+- (instancetype)initWithWriter:(POSAtomicFileWriter *)writer cipher:(POSEncryptedChunkCipher *)cipher {
+    if (self = [super init]) {
+        _writer = writer;
+        _cipher = cipher;
+        _plaintext = malloc(cipher.chunkSize);
+        _ciphertext = malloc(cipher.chunkSize);
+        POS_CHECK(_plaintext && _ciphertext);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    POSSecureZero(_plaintext, _cipher.chunkSize);
+    free(_plaintext);
+    free(_ciphertext);
+}
+
+- (BOOL)writeBytes:(const void *)bytes length:(NSUInteger)length error:(NSError **)error {
+    const uint8_t *input = bytes;
+    while (length > 0) {
+        if (_length == _cipher.chunkSize && ![self p_writeChunkWithFlags:POSEncryptedChunkFlagsNone error:error]) {
+            return NO;
+        }
+        NSUInteger count = MIN(length, _cipher.chunkSize - _length);
+        memcpy(_plaintext + _length, input, count);
+        _length += count;
+        input += count;
+        length -= count;
+    }
+    return YES;
+}
+
+- (BOOL)writeData:(NSData *)data error:(NSError **)error {
+    return [self writeBytes:data.bytes length:data.length error:error];
+}
+
+/// Writes buffered bytes as the last chunk.
+- (BOOL)finish:(NSError **)error {
+    return [self p_writeChunkWithFlags:POSEncryptedChunkFlagsLast error:error];
+}
+
+- (BOOL)p_writeChunkWithFlags:(POSEncryptedChunkFlags)flags error:(NSError **)error {
+    if (![_cipher transformBytes:_plaintext length:_length output:_ciphertext error:error]) {
+        return NO;
+    }
+    uint8_t tag[kPOSEncryptedTagSize];
+    [_cipher computeTag:tag ofCiphertext:_ciphertext length:(uint32_t)_length flags:flags];
+    uint32_t chunkLength = CFSwapInt32HostToLittle((uint32_t)_length);
+    if (![_writer writeBytes:&flags length:sizeof(flags) error:error] ||
+        ![_writer writeBytes:&chunkLength length:sizeof(chunkLength) error:error] ||
+        ![_writer writeBytes:_ciphertext length:_length error:error] ||
+        ![_writer writeBytes:tag length:sizeof(tag) error:error]) {
+        return NO;
+    }
+    POSSecureZero(_plaintext, _length);
+    _length = 0;
+    [_cipher advance];
+    return YES;
+}
+
+@end
+
+#pragma mark -
+
+/// Reads encrypted chunks from the file, verifies and decrypts them.
+@interface POSDecryptingSource : NSObject <POSByteSource>
+@end
+
+@implementation POSDecryptingSource {
+    POSFileReader *_reader;
+    POSEncryptedChunkCipher *_cipher;
+    uint8_t *_plaintext;
+    uint8_t *_ciphertext;
+    NSUInteger _length;
+    NSUInteger _offset;
+    BOOL _lastChunkRead;
+}
+
+- (instancetype)initWithReader:(POSFileReader *)reader cipher:(POSEncryptedChunkCipher *)cipher {
+    if (self = [super init]) {
+        _reader = reader;
+        _cipher = cipher;
+        _plaintext = malloc(cipher.chunkSize);
+        _ciphertext = malloc(cipher.chunkSize);
+        POS_CHECK(_plaintext && _ciphertext);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    POSSecureZero(_plaintext, _cipher.chunkSize);
+    free(_plaintext);
+    free(_ciphertext);
+}
+
+- (BOOL)readBytes:(void *)bytes length:(NSUInteger)length error:(NSError **)error {
+    uint8_t *output = bytes;
+    while (length > 0) {
+        if (_offset == _length) {
+            if (_lastChunkRead) {
+                POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Unexpected end of %@", _reader.filePath]);
+                return NO;
+            }
+            if (![self p_readChunk:error]) {
+                return NO;
+            }
+            continue;
+        }
+        NSUInteger count = MIN(length, _length - _offset);
+        memcpy(output, _plaintext + _offset, count);
+        _offset += count;
+        output += count;
+        length -= count;
+    }
+    return YES;
+}
+
+- (nullable NSData *)readDataOfLength:(NSUInteger)length error:(NSError **)error {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    if (![self readBytes:data.mutableBytes length:length error:error]) {
+        return nil;
+    }
+    return data;
+}
+
+/// Checks that the stream was consumed up to the end of the last chunk and the file has nothing after it.
+- (BOOL)finish:(NSError **)error {
+    uint8_t extra;
+    if (!_lastChunkRead || _offset != _length || [_reader readBytes:&extra maxLength:sizeof(extra) error:nil] != 0) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Trailing data in %@", _reader.filePath]);
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)p_readChunk:(NSError **)error {
+    POSEncryptedChunkFlags flags;
+    uint32_t chunkLength;
+    if (![_reader readBytes:&flags length:sizeof(flags) error:error] ||
+        ![_reader readBytes:&chunkLength length:sizeof(chunkLength) error:error]) {
+        return NO;
+    }
+    chunkLength = CFSwapInt32LittleToHost(chunkLength);
+    if (chunkLength > _cipher.chunkSize || (flags & ~POSEncryptedChunkFlagsLast) != 0) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Corrupted chunk in %@", _reader.filePath]);
+        return NO;
+    }
+    uint8_t tag[kPOSEncryptedTagSize];
+    uint8_t expectedTag[kPOSEncryptedTagSize];
+    if (![_reader readBytes:_ciphertext length:chunkLength error:error] ||
+        ![_reader readBytes:tag length:sizeof(tag) error:error]) {
+        return NO;
+    }
+    [_cipher computeTag:expectedTag ofCiphertext:_ciphertext length:chunkLength flags:flags];
+    if (!POSConstantTimeEqual(tag, expectedTag, sizeof(tag))) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Failed to authenticate %@", _reader.filePath]);
+        return NO;
+    }
+    if (![_cipher transformBytes:_ciphertext length:chunkLength output:_plaintext error:error]) {
+        return NO;
+    }
+    [_cipher advance];
+    _length = chunkLength;
+    _offset = 0;
+    _lastChunkRead = (flags & POSEncryptedChunkFlagsLast) != 0;
+    return YES;
+}
+
+@end
+
+#pragma mark -
+
+@interface POSEncryptedFileValueStore ()
+@property (nonatomic, readonly) NSData *key;
+@end
+
+@implementation POSEncryptedFileValueStore
+
+- (instancetype)initWithFilePath:(NSString *)filePath key:(NSData *)key {
+    return [self initWithFilePath:filePath key:key chunkSize:POSFileIODefaultBufferSize];
+}
+
+- (instancetype)initWithFilePath:(NSString *)filePath key:(NSData *)key chunkSize:(NSUInteger)chunkSize {
+    POS_CHECK(key.length == POSEncryptedFileValueStoreKeySize);
+    POS_CHECK(chunkSize > 0 && chunkSize <= kPOSEncryptedMaxChunkSize);
+    if (self = [super initWithFilePath:filePath bufferSize:chunkSize]) {
+        _key = [key copy];
+    }
+    return self;
+}
+
++ (nullable NSData *)generateKey:(NSError **)error {
+    NSMutableData *key = [NSMutableData dataWithLength:POSEncryptedFileValueStoreKeySize];
+    if (SecRandomCopyBytes(kSecRandomDefault, key.length, key.mutableBytes) != 0) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Failed to generate random key."]);
+        return nil;
+    }
+    return key;
+}
+
+#pragma mark - POSValueStore
+
+- (BOOL)saveValue:(nullable POSLensValue<NSCoding> *)value error:(NSError **)error {
+    if (value == nil) {
+        return [self removeData:error];
+    }
+    uint8_t nonce[kPOSEncryptedNonceSize];
+    if (SecRandomCopyBytes(kSecRandomDefault, sizeof(nonce), nonce) != 0) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Failed to generate nonce for %@", self.filePath]);
+        return NO;
+    }
+    NSData *header = [self p_headerWithChunkSize:self.bufferSize nonce:nonce];
+    POSEncryptedChunkCipher *cipher = [[POSEncryptedChunkCipher alloc] initWithOperation:kCCEncrypt
+                                                                                     key:_key
+                                                                                  header:header
+                                                                               chunkSize:self.bufferSize
+                                                                                   error:error];
+    if (!cipher) {
+        return NO;
+    }
+    POSAtomicFileWriter *writer = [[POSAtomicFileWriter alloc] initWithFilePath:self.filePath bufferSize:self.bufferSize];
+    if (![writer open:error]) {
+        return NO;
+    }
+    @try {
+        POSEncryptingSink *sink = [[POSEncryptingSink alloc] initWithWriter:writer cipher:cipher];
+        if (![writer writeData:header error:error] ||
+            ![self writeValue:value toSink:sink error:error] ||
+            ![sink finish:error]) {
+            [writer abort];
+            return NO;
+        }
+        return [writer commit:error];
+    } @catch (NSException *exception) {
+        [writer abort];
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        return NO;
+    }
+}
+
+- (nullable POSLensValue<NSCoding> *)loadValue:(NSError **)error {
+    if (![[NSFileManager defaultManager] fileExistsAtPath:self.filePath]) {
+        return nil;
+    }
+    POSFileReader *reader = [[POSFileReader alloc] initWithFilePath:self.filePath bufferSize:self.bufferSize];
+    if (![reader open:error]) {
+        return nil;
+    }
+    uint8_t magic[sizeof(kPOSEncryptedMagic)];
+    uint32_t chunkSize;
+    uint8_t nonce[kPOSEncryptedNonceSize];
+    if (![reader readBytes:magic length:sizeof(magic) error:nil] ||
+        memcmp(magic, kPOSEncryptedMagic, sizeof(magic)) != 0 ||
+        ![reader readBytes:&chunkSize length:sizeof(chunkSize) error:nil] ||
+        ![reader readBytes:nonce length:sizeof(nonce) error:nil]) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"%@ is not an encrypted value file.", self.filePath]);
+        return nil;
+    }
+    chunkSize = CFSwapInt32LittleToHost(chunkSize);
+    if (chunkSize == 0 || chunkSize > kPOSEncryptedMaxChunkSize) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Corrupted header in %@", self.filePath]);
+        return nil;
+    }
+    NSData *header = [self p_headerWithChunkSize:chunkSize nonce:nonce];
+    POSEncryptedChunkCipher *cipher = [[POSEncryptedChunkCipher alloc] initWithOperation:kCCDecrypt
+                                                                                     key:_key
+                                                                                  header:header
+                                                                               chunkSize:chunkSize
+                                                                                   error:error];
+    if (!cipher) {
+        return nil;
+    }
+    @try {
+        POSDecryptingSource *source = [[POSDecryptingSource alloc] initWithReader:reader cipher:cipher];
+        POSLensValue<NSCoding> *value = [self readValueFromSource:source
+                                                   maxFrameLength:reader.fileSize
+                                                            error:error];
+        if (!value || ![source finish:error]) {
+            return nil;
+        }
+        POS_CHECK([value conformsToProtocol:@protocol(POSLensPolicy)]);
+        POS_CHECK([value conformsToProtocol:@protocol(NSCopying)]);
+        return value;
+    } @catch (NSException *exception) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        return nil;
+    }
+}
+
+#pragma mark - Private
+
+- (NSData *)p_headerWithChunkSize:(NSUInteger)chunkSize nonce:(const uint8_t *)nonce {
+    uint32_t chunkLength = CFSwapInt32HostToLittle((uint32_t)chunkSize);
+    NSMutableData *header = [NSMutableData dataWithBytes:kPOSEncryptedMagic length:sizeof(kPOSEncryptedMagic)];
+    [header appendBytes:&chunkLength length:sizeof(chunkLength)];
+    [header appendBytes:nonce length:kPOSEncryptedNonceSize];
+    return header;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -12,6 +12,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface POSFileValueStore : POSPersistentValueStore
 
+/// Path to the file with serialized value.
+@property (nonatomic, readonly) NSString *filePath;
+
 /// The designated initializer.
 - (instancetype)initWithFilePath:(NSString *)filePath;
 
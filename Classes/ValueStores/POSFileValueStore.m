@@ -11,10 +11,6 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface POSFileValueStore ()
-@property (nonatomic, readonly) NSString *filePath;
-@end
-
 @implementation POSFileValueStore
 
 - (instancetype)initWithFilePath:(NSString *)filePath {
@@ -10,12 +10,37 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Codecs for compressing serialized values.
+typedef NS_ENUM(uint8_t, POSValueCompression) {
+    POSValueCompressionNone = 0,
+    POSValueCompressionLZ4 = 1
+};
+
 ///
 /// Abstract POSValueStore protocol implementation.
 /// It serializes and deserializes value and calls POSValueStore method with ready to use object instance.
 ///
 @interface POSPersistentValueStore : NSObject <POSValueStore>
 
+///
+/// @brief      Codec for compressing serialized value before passing it to saveData:error: method.
+///
+/// @discussion Compressed data starts with the header which contains the codec and the size of
+///             the original data. Loaded data is decompressed according to its header, so the store
+///             reads values which were saved with any compression settings. Default is POSValueCompressionNone.
+///
+/// @remarks    The property should be configured before creating the lens with that store.
+///
+@property (nonatomic) POSValueCompression compression;
+
+///
+/// @brief      The size of serialized value below which it is saved without compression.
+///
+/// @discussion Data is also saved without compression if the compressed data is not smaller than
+///             the original one. Default is 1024 bytes.
+///
+@property (nonatomic) NSUInteger compressionThreshold;
+
 ///
 /// Abstract method for saving serialied value instance.
 /// The method should be overrided in subclasses.
@@ -34,6 +59,20 @@ NS_ASSUME_NONNULL_BEGIN
 ///
 - (BOOL)removeData:(NSError **)error;
 
+#pragma mark Subclassing
+
+///
+/// Compresses serialized data according to the compression settings.
+/// Returns the data as is if it is below the threshold or doesn't shrink.
+///
+- (NSData *)compressData:(NSData *)data;
+
+///
+/// Decompresses data according to its header. Data without the header is returned as is.
+/// Returns nil and `error` out parameter if the data is corrupted.
+///
+- (nullable NSData *)decompressData:(NSData *)data error:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
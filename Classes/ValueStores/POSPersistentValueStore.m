@@ -7,12 +7,30 @@
 //
 
 #import "POSPersistentValueStore.h"
+#import "POSKeyedArchiving.h"
+#import "POSLZ4.h"
 #import <POSErrorHandling/POSErrorHandling.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
+static const uint8_t kPOSCompressionMagic[4] = {'P', 'O', 'S', 'Z'};
+
+/// Compressed data layout: magic, codec, little endian size of the original data, payload.
+typedef struct __attribute__((packed)) {
+    uint8_t magic[4];
+    uint8_t codec;
+    uint64_t originalSize;
+} POSCompressionHeader;
+
 @implementation POSPersistentValueStore
 
+- (instancetype)init {
+    if (self = [super init]) {
+        _compressionThreshold = 1024;
+    }
+    return self;
+}
+
 #pragma mark - POSValueStore
 
 - (BOOL)saveValue:(nullable POSLensValue<NSCoding> *)value error:(NSError **)error {
@@ -20,12 +38,7 @@ NS_ASSUME_NONNULL_BEGIN
         if (value == nil) {
             return [self removeData:error];
         }        
-        NSMutableData *data = [NSMutableData data];
-        NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc ] initForWritingWithMutableData:data];
-        [archiver setOutputFormat:NSPropertyListBinaryFormat_v1_0];
-        [archiver encodeRootObject:value];
-        [archiver finishEncoding];
-        return [self saveData:data error:error];
+        return [self saveData:[self compressData:POSArchiveObject(value)] error:error];
     } @catch (NSException *exception) {
         POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
         return NO;
@@ -35,11 +48,13 @@ NS_ASSUME_NONNULL_BEGIN
 - (nullable POSLensValue<NSCoding> *)loadValue:(NSError **)error {
     @try {
         NSData *data = [self loadData:error];
+        if (data) {
+            data = [self decompressData:data error:error];
+        }
         if (!data) {
             return nil;
         }
-        NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
-        POSLensValue<NSCoding> *value = [unarchiver decodeObject];
+        POSLensValue<NSCoding> *value = POSUnarchiveObject(data);
         POS_CHECK([value conformsToProtocol:@protocol(POSLensPolicy)]);
         POS_CHECK([value conformsToProtocol:@protocol(NSCopying)]);
         return value;
@@ -63,6 +78,64 @@ NS_ASSUME_NONNULL_BEGIN
     return YES;
 }
 
+#pragma mark - Subclassing
+
+- (NSData *)compressData:(NSData *)data {
+    if (_compression == POSValueCompressionNone || data.length < _compressionThreshold) {
+        return data;
+    }
+    size_t bound = POSLZ4CompressBound(data.length);
+    if (bound == 0) {
+        return data;
+    }
+    NSMutableData *compressedData = [NSMutableData dataWithLength:sizeof(POSCompressionHeader) + bound];
+    POSCompressionHeader *header = compressedData.mutableBytes;
+    memcpy(header->magic, kPOSCompressionMagic, sizeof(kPOSCompressionMagic));
+    header->codec = _compression;
+    header->originalSize = CFSwapInt64HostToLittle(data.length);
+    size_t compressedSize = POSLZ4Compress(data.bytes,
+                                           data.length,
+                                           (uint8_t *)compressedData.mutableBytes + sizeof(POSCompressionHeader),
+                                           bound);
+    if (compressedSize == 0 || sizeof(POSCompressionHeader) + compressedSize >= data.length) {
+        return data;
+    }
+    compressedData.length = sizeof(POSCompressionHeader) + compressedSize;
+    return compressedData;
+}
+
+- (nullable NSData *)decompressData:(NSData *)data error:(NSError **)error {
+    if (data.length < sizeof(POSCompressionHeader) ||
+        memcmp(data.bytes, kPOSCompressionMagic, sizeof(kPOSCompressionMagic)) != 0) {
+        return data;
+    }
+    POSCompressionHeader header;
+    memcpy(&header, data.bytes, sizeof(header));
+    uint64_t originalSize = CFSwapInt64LittleToHost(header.originalSize);
+    const uint8_t *payload = (const uint8_t *)data.bytes + sizeof(header);
+    size_t payloadSize = data.length - sizeof(header);
+    switch ((POSValueCompression)header.codec) {
+        case POSValueCompressionNone:
+            return [data subdataWithRange:NSMakeRange(sizeof(header), payloadSize)];
+        case POSValueCompressionLZ4: {
+            if (originalSize > NSIntegerMax || originalSize > 255 * (uint64_t)payloadSize) {
+                POSAssignError(error, [NSError pos_systemErrorWithFormat:
+                                       @"Corrupted LZ4 header: size=%@", @(originalSize)]);
+                return nil;
+            }
+            NSMutableData *originalData = [NSMutableData dataWithLength:(NSUInteger)originalSize];
+            long size = POSLZ4Decompress(payload, payloadSize, originalData.mutableBytes, originalData.length);
+            if (size != (long)originalSize) {
+                POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Failed to decompress LZ4 data."]);
+                return nil;
+            }
+            return originalData;
+        }
+    }
+    POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Unknown compression codec %@", @(header.codec)]);
+    return nil;
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,48 @@
+//
+//  POSSQLiteValueStore.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSValueStore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///
+/// Value store which maps the value's tree onto the SQLite table keyed by key path.
+///
+/// @discussion Dictionaries with string keys are decomposed into rows, one row per key path.
+///             All other objects are persisted as leaves using NSKeyedArchiver, so they should
+///             conform to NSCoding protocol. The store remembers the last persisted value and
+///             writes only those subtrees which were replaced by the lens. Thus updating one leaf
+///             results in a single-row upsert inside a transaction. The database works in WAL mode with
+///             full synchronization, so committed values survive power loss like in the file stores.
+///
+///             The store rewrites the whole subtree instead of the difference if other connections
+///             changed the database since the last save, for example another store instance or process.
+///             The lens which is created for the keypath of the store loads and saves only rows of its subtree.
+///
+@interface POSSQLiteValueStore : NSObject <POSKeyPathValueStore>
+
+///
+/// The convenience initializer which uses 'pos_lens_values' table.
+/// @param filePath Path to the SQLite database file.
+///
+- (instancetype)initWithFilePath:(NSString *)filePath;
+
+///
+/// The designated initializer.
+/// @param filePath  Path to the SQLite database file. It will be created on first access.
+/// @param tableName The name of the table for the value. Several stores may share one database file
+///                  if they use different tables.
+///
+- (instancetype)initWithFilePath:(NSString *)filePath tableName:(NSString *)tableName;
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,463 @@
+//
+//  POSSQLiteValueStore.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSSQLiteValueStore.h"
+#import "NSError+POSLens.h"
+#import "POSKeyedArchiving.h"
+#import <sqlite3.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Key path of the root value. All other key paths are built as '$.key1.key2'.
+static NSString * const kPOSRootKeyPath = @"$";
+
+@interface POSSQLiteValueStore ()
+@property (nonatomic, readonly) NSString *filePath;
+@property (nonatomic, readonly) NSString *tableName;
+@property (nonatomic, readonly) dispatch_queue_t syncQueue;
+/// Last persisted or loaded subtrees by their key paths. NSNull means missing subtree.
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, id> *persistedNodes;
+@end
+
+@implementation POSSQLiteValueStore {
+    sqlite3 *_db;
+    sqlite3_stmt *_upsertStatement;
+    sqlite3_stmt *_deleteStatement;
+    sqlite3_stmt *_selectStatement;
+    sqlite3_stmt *_selectContainerStatement;
+    sqlite3_stmt *_dataVersionStatement;
+    sqlite3_int64 _dataVersion;
+}
+
+- (instancetype)initWithFilePath:(NSString *)filePath {
+    return [self initWithFilePath:filePath tableName:@"pos_lens_values"];
+}
+
+- (instancetype)initWithFilePath:(NSString *)filePath tableName:(NSString *)tableName {
+    POS_CHECK(filePath);
+    POS_CHECK(tableName.length > 0 && [tableName rangeOfString:@"\""].location == NSNotFound);
+    if (self = [super init]) {
+        _filePath = [filePath copy];
+        _tableName = [tableName copy];
+        _syncQueue = dispatch_queue_create("com.github.pavelosipov.POSSQLiteValueStore", DISPATCH_QUEUE_SERIAL);
+        _persistedNodes = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self p_closeDatabase];
+}
+
+#pragma mark - POSValueStore
+
+- (BOOL)saveValue:(nullable POSLensValue *)value error:(NSError **)error {
+    return [self saveValue:value atKeyPath:@"" error:error];
+}
+
+- (nullable POSLensValue *)loadValue:(NSError **)error {
+    __block POSLensValue *value = nil;
+    __block NSError *loadError = nil;
+    dispatch_sync(_syncQueue, ^{
+        value = [self p_loadValueAtKeyPath:kPOSRootKeyPath error:&loadError];
+        if (value != nil && ![value conformsToProtocol:@protocol(NSCopying)]) {
+            loadError = [NSError pos_systemErrorWithFormat:@"Loaded value %@ doesn't conform to NSCopying.", value];
+            value = nil;
+        }
+    });
+    POSAssignError(error, loadError);
+    return value;
+}
+
+#pragma mark - POSKeyPathValueStore
+
+- (nullable id)loadValueAtKeyPath:(NSString *)keyPath error:(NSError **)error {
+    NSString *storeKeyPath = [self.class p_storeKeyPathWithKeyPath:keyPath];
+    __block id value = nil;
+    __block NSError *loadError = nil;
+    dispatch_sync(_syncQueue, ^{
+        value = [self p_loadValueAtKeyPath:storeKeyPath error:&loadError];
+    });
+    POSAssignError(error, loadError);
+    return value;
+}
+
+- (BOOL)saveValue:(nullable id)value atKeyPath:(NSString *)keyPath error:(NSError **)error {
+    NSString *storeKeyPath = [self.class p_storeKeyPathWithKeyPath:keyPath];
+    __block BOOL saved = NO;
+    __block NSError *saveError = nil;
+    dispatch_sync(_syncQueue, ^{
+        saved = [self p_saveValue:value atKeyPath:storeKeyPath error:&saveError];
+    });
+    POSAssignError(error, saveError);
+    return saved;
+}
+
+#pragma mark - Private
+
+- (BOOL)p_saveValue:(nullable id)value atKeyPath:(NSString *)keyPath error:(NSError **)error {
+    if (![self p_openDatabase:error] || ![self p_validatePersistedNodes:error]) {
+        return NO;
+    }
+    id persistedNode = _persistedNodes[keyPath];
+    if (persistedNode != nil && value == (persistedNode == [NSNull null] ? nil : persistedNode)) {
+        return YES;
+    }
+    if (![self p_executeSQL:@"BEGIN IMMEDIATE" error:error]) {
+        return NO;
+    }
+    BOOL saved = NO;
+    @try {
+        // Other connections might commit after the check above, but not inside the write transaction.
+        saved = [self p_validatePersistedNodes:error];
+        persistedNode = _persistedNodes[keyPath];
+        if (saved && value != nil && ![keyPath isEqualToString:kPOSRootKeyPath]) {
+            saved = [self p_insertAncestorsOfKeyPath:keyPath error:error];
+        }
+        if (saved && persistedNode != nil) {
+            saved = [self p_saveNode:value
+                             oldNode:(persistedNode == [NSNull null] ? nil : persistedNode)
+                             keyPath:keyPath
+                               error:error];
+        } else if (saved) {
+            saved = ([self p_deleteSubtreeAtKeyPath:keyPath error:error] &&
+                     [self p_saveNode:value oldNode:nil keyPath:keyPath error:error]);
+        }
+    } @catch (NSException *exception) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        saved = NO;
+    }
+    if (!saved) {
+        [self p_executeSQL:@"ROLLBACK" error:nil];
+        return NO;
+    }
+    if (![self p_executeSQL:@"COMMIT" error:error]) {
+        [self p_executeSQL:@"ROLLBACK" error:nil];
+        return NO;
+    }
+    [self p_setPersistedNode:value atKeyPath:keyPath];
+    return YES;
+}
+
+///
+/// Forgets persisted subtrees if other connections have changed the database. Diffs against
+/// such subtrees would skip rows which were overwritten by those connections.
+///
+- (BOOL)p_validatePersistedNodes:(NSError **)error {
+    int status = sqlite3_step(_dataVersionStatement);
+    sqlite3_int64 dataVersion = (status == SQLITE_ROW ? sqlite3_column_int64(_dataVersionStatement, 0) : 0);
+    sqlite3_reset(_dataVersionStatement);
+    if (status != SQLITE_ROW) {
+        POSAssignError(error, [self p_databaseErrorWithReason:@"Failed to read data version"]);
+        return NO;
+    }
+    if (dataVersion != _dataVersion) {
+        [_persistedNodes removeAllObjects];
+        _dataVersion = dataVersion;
+    }
+    return YES;
+}
+
+/// Replaces remembered subtree and forgets all subtrees which overlap with it.
+- (void)p_setPersistedNode:(nullable id)node atKeyPath:(NSString *)keyPath {
+    NSString *descendantPrefix = [keyPath stringByAppendingString:@"."];
+    for (NSString *persistedKeyPath in _persistedNodes.allKeys) {
+        if ([persistedKeyPath isEqualToString:keyPath] ||
+            [persistedKeyPath hasPrefix:descendantPrefix] ||
+            [keyPath hasPrefix:[persistedKeyPath stringByAppendingString:@"."]]) {
+            [_persistedNodes removeObjectForKey:persistedKeyPath];
+        }
+    }
+    _persistedNodes[keyPath] = node ?: [NSNull null];
+}
+
+/// Creates missing parent dictionaries of the subtree.
+- (BOOL)p_insertAncestorsOfKeyPath:(NSString *)keyPath error:(NSError **)error {
+    NSArray<NSString *> *components = [keyPath componentsSeparatedByString:@"."];
+    NSString *ancestorKeyPath = components.firstObject;
+    for (NSUInteger i = 1; i < components.count; ++i) {
+        sqlite3_stmt *statement = _selectContainerStatement;
+        sqlite3_bind_text(statement, 1, ancestorKeyPath.UTF8String, -1, SQLITE_TRANSIENT);
+        int status = sqlite3_step(statement);
+        BOOL isContainer = (status == SQLITE_ROW && sqlite3_column_int(statement, 0) != 0);
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        if (status == SQLITE_DONE) {
+            if (![self p_upsertData:nil atKeyPath:ancestorKeyPath error:error]) {
+                return NO;
+            }
+        } else if (status != SQLITE_ROW) {
+            POSAssignError(error, [self p_databaseErrorWithReason:@"Failed to select parent value"]);
+            return NO;
+        } else if (!isContainer) {
+            POSAssignError(error, [NSError pos_lensErrorWithFormat:@"Value at %@ is not a dictionary.", ancestorKeyPath]);
+            return NO;
+        }
+        ancestorKeyPath = [NSString stringWithFormat:@"%@.%@", ancestorKeyPath, components[i]];
+    }
+    return YES;
+}
+
+///
+/// Writes the difference between two trees. The lens updates values using copy on write idiom,
+/// so untouched subtrees are the same instances in the old and the new trees and can be skipped.
+///
+- (BOOL)p_saveNode:(nullable id)node
+           oldNode:(nullable id)oldNode
+           keyPath:(NSString *)keyPath
+             error:(NSError **)error {
+    if (node == oldNode) {
+        return YES;
+    }
+    BOOL isContainer = POSIsStringKeyedDictionary(node);
+    BOOL wasContainer = POSIsStringKeyedDictionary(oldNode);
+    if (isContainer && wasContainer) {
+        NSDictionary *dictionary = node;
+        NSDictionary *oldDictionary = oldNode;
+        for (NSString *key in dictionary) {
+            if (![self p_saveNode:dictionary[key]
+                          oldNode:oldDictionary[key]
+                          keyPath:[self.class p_keyPath:keyPath appendingKey:key]
+                            error:error]) {
+                return NO;
+            }
+        }
+        for (NSString *key in oldDictionary) {
+            if (dictionary[key] == nil &&
+                ![self p_deleteSubtreeAtKeyPath:[self.class p_keyPath:keyPath appendingKey:key] error:error]) {
+                return NO;
+            }
+        }
+        return YES;
+    }
+    if (wasContainer || (node == nil && oldNode != nil)) {
+        if (![self p_deleteSubtreeAtKeyPath:keyPath error:error]) {
+            return NO;
+        }
+    }
+    if (node == nil) {
+        return YES;
+    }
+    if (isContainer) {
+        if (![self p_upsertData:nil atKeyPath:keyPath error:error]) {
+            return NO;
+        }
+        NSDictionary *dictionary = node;
+        for (NSString *key in dictionary) {
+            if (![self p_saveNode:dictionary[key]
+                          oldNode:nil
+                          keyPath:[self.class p_keyPath:keyPath appendingKey:key]
+                            error:error]) {
+                return NO;
+            }
+        }
+        return YES;
+    }
+    if (!wasContainer && [node isEqual:oldNode]) {
+        return YES;
+    }
+    return [self p_upsertData:POSArchiveObject(node) atKeyPath:keyPath error:error];
+}
+
+- (nullable id)p_loadValueAtKeyPath:(NSString *)keyPath error:(NSError **)error {
+    if (![self p_openDatabase:error] || ![self p_validatePersistedNodes:error]) {
+        return nil;
+    }
+    @try {
+        sqlite3_stmt *statement = _selectStatement;
+        [self p_bindSubtreeAtKeyPath:keyPath toStatement:statement];
+        id value = nil;
+        NSMutableDictionary<NSString *, NSMutableDictionary *> *containers = [NSMutableDictionary new];
+        int status;
+        while ((status = sqlite3_step(statement)) == SQLITE_ROW) {
+            NSString *rowKeyPath = [NSString stringWithUTF8String:(const char *)sqlite3_column_text(statement, 0)];
+            id node = nil;
+            if (sqlite3_column_type(statement, 1) == SQLITE_NULL) {
+                node = [NSMutableDictionary new];
+                containers[rowKeyPath] = node;
+            } else {
+                NSData *data = [NSData
+                                dataWithBytesNoCopy:(void *)sqlite3_column_blob(statement, 1)
+                                length:(NSUInteger)sqlite3_column_bytes(statement, 1)
+                                freeWhenDone:NO];
+                node = POSUnarchiveObject(data);
+            }
+            if ([rowKeyPath isEqualToString:keyPath]) {
+                value = node;
+                continue;
+            }
+            NSRange separator = [rowKeyPath rangeOfString:@"." options:NSBackwardsSearch];
+            NSString *parentKeyPath = [rowKeyPath substringToIndex:separator.location];
+            NSString *key = [self.class p_keyFromKeyPathComponent:[rowKeyPath substringFromIndex:NSMaxRange(separator)]];
+            containers[parentKeyPath][key] = node;
+        }
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        if (status != SQLITE_DONE) {
+            POSAssignError(error, [self p_databaseErrorWithReason:@"Failed to select value"]);
+            return nil;
+        }
+        value = [self.class p_freezeNode:value keyPath:keyPath containers:containers];
+        [self p_setPersistedNode:value atKeyPath:keyPath];
+        return value;
+    } @catch (NSException *exception) {
+        sqlite3_reset(_selectStatement);
+        sqlite3_clear_bindings(_selectStatement);
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        return nil;
+    }
+}
+
+- (BOOL)p_upsertData:(nullable NSData *)data atKeyPath:(NSString *)keyPath error:(NSError **)error {
+    sqlite3_stmt *statement = _upsertStatement;
+    sqlite3_bind_text(statement, 1, keyPath.UTF8String, -1, SQLITE_TRANSIENT);
+    if (data) {
+        sqlite3_bind_blob(statement, 2, data.bytes, (int)data.length, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(statement, 2);
+    }
+    return [self p_stepStatement:statement reason:@"Failed to upsert value" error:error];
+}
+
+- (BOOL)p_deleteSubtreeAtKeyPath:(NSString *)keyPath error:(NSError **)error {
+    [self p_bindSubtreeAtKeyPath:keyPath toStatement:_deleteStatement];
+    return [self p_stepStatement:_deleteStatement reason:@"Failed to delete value" error:error];
+}
+
+/// All descendants of 'a.b' have key paths in the half-open range ['a.b.', 'a.b/').
+- (void)p_bindSubtreeAtKeyPath:(NSString *)keyPath toStatement:(sqlite3_stmt *)statement {
+    sqlite3_bind_text(statement, 1, keyPath.UTF8String, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 2, [keyPath stringByAppendingString:@"."].UTF8String, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 3, [keyPath stringByAppendingString:@"/"].UTF8String, -1, SQLITE_TRANSIENT);
+}
+
+- (BOOL)p_stepStatement:(sqlite3_stmt *)statement reason:(NSString *)reason error:(NSError **)error {
+    int status = sqlite3_step(statement);
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+    if (status != SQLITE_DONE) {
+        POSAssignError(error, [self p_databaseErrorWithReason:reason]);
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)p_executeSQL:(NSString *)SQL error:(NSError **)error {
+    if (sqlite3_exec(_db, SQL.UTF8String, NULL, NULL, NULL) != SQLITE_OK) {
+        POSAssignError(error, [self p_databaseErrorWithReason:
+                               [NSString stringWithFormat:@"Failed to execute '%@'", SQL]]);
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)p_openDatabase:(NSError **)error {
+    if (_db != NULL) {
+        return YES;
+    }
+    int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+    if (sqlite3_open_v2(_filePath.fileSystemRepresentation, &_db, flags, NULL) != SQLITE_OK) {
+        POSAssignError(error, [NSError pos_fileErrorWithPath:_filePath reason:
+                               [self p_databaseErrorWithReason:@"Failed to open database"]]);
+        [self p_closeDatabase];
+        return NO;
+    }
+    NSString *schema = [NSString stringWithFormat:
+                        @"PRAGMA journal_mode=WAL;"
+                        @"PRAGMA synchronous=FULL;"
+                        @"CREATE TABLE IF NOT EXISTS \"%@\" (key_path TEXT PRIMARY KEY NOT NULL, data BLOB);",
+                        _tableName];
+    if (![self p_executeSQL:schema error:error]) {
+        [self p_closeDatabase];
+        return NO;
+    }
+    NSString *subtree = @"key_path = ?1 OR (key_path >= ?2 AND key_path < ?3)";
+    NSString *upsertSQL = [NSString stringWithFormat:
+                           @"INSERT OR REPLACE INTO \"%@\" (key_path, data) VALUES (?1, ?2)", _tableName];
+    NSString *deleteSQL = [NSString stringWithFormat:
+                           @"DELETE FROM \"%@\" WHERE %@", _tableName, subtree];
+    NSString *selectSQL = [NSString stringWithFormat:
+                           @"SELECT key_path, data FROM \"%@\" WHERE %@ ORDER BY key_path", _tableName, subtree];
+    NSString *selectContainerSQL = [NSString stringWithFormat:
+                                    @"SELECT data IS NULL FROM \"%@\" WHERE key_path = ?1", _tableName];
+    if (sqlite3_prepare_v2(_db, upsertSQL.UTF8String, -1, &_upsertStatement, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(_db, deleteSQL.UTF8String, -1, &_deleteStatement, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(_db, selectSQL.UTF8String, -1, &_selectStatement, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(_db, selectContainerSQL.UTF8String, -1, &_selectContainerStatement, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(_db, "PRAGMA data_version", -1, &_dataVersionStatement, NULL) != SQLITE_OK) {
+        POSAssignError(error, [self p_databaseErrorWithReason:@"Failed to prepare statements"]);
+        [self p_closeDatabase];
+        return NO;
+    }
+    return YES;
+}
+
+- (void)p_closeDatabase {
+    sqlite3_finalize(_upsertStatement);
+    sqlite3_finalize(_deleteStatement);
+    sqlite3_finalize(_selectStatement);
+    sqlite3_finalize(_selectContainerStatement);
+    sqlite3_finalize(_dataVersionStatement);
+    sqlite3_close(_db);
+    _upsertStatement = NULL;
+    _deleteStatement = NULL;
+    _selectStatement = NULL;
+    _selectContainerStatement = NULL;
+    _dataVersionStatement = NULL;
+    _db = NULL;
+}
+
+- (NSError *)p_databaseErrorWithReason:(NSString *)reason {
+    if (_db == NULL) {
+        return [NSError pos_systemErrorWithFormat:@"%@: out of memory", reason];
+    }
+    return [NSError pos_systemErrorWithFormat:@"%@: %s (code=%@)",
+            reason, sqlite3_errmsg(_db), @(sqlite3_extended_errcode(_db))];
+}
+
+#pragma mark - Private Tree Utils
+
++ (nullable id)p_freezeNode:(nullable id)node
+                    keyPath:(NSString *)keyPath
+                 containers:(NSDictionary<NSString *, NSMutableDictionary *> *)containers {
+    if (node == nil || containers[keyPath] != node) {
+        return node;
+    }
+    NSMutableDictionary *dictionary = node;
+    NSMutableDictionary *frozen = [NSMutableDictionary dictionaryWithCapacity:dictionary.count];
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(NSString *key, id child, BOOL *stop) {
+        frozen[key] = [self p_freezeNode:child keyPath:[self p_keyPath:keyPath appendingKey:key] containers:containers];
+    }];
+    return [frozen copy];
+}
+
++ (NSString *)p_storeKeyPathWithKeyPath:(NSString *)keyPath {
+    POS_CHECK(keyPath);
+    NSString *storeKeyPath = kPOSRootKeyPath;
+    if (keyPath.length > 0) {
+        for (NSString *key in [keyPath componentsSeparatedByString:@"."]) {
+            storeKeyPath = [self p_keyPath:storeKeyPath appendingKey:key];
+        }
+    }
+    return storeKeyPath;
+}
+
++ (NSString *)p_keyPath:(NSString *)keyPath appendingKey:(NSString *)key {
+    NSString *component = [[key
+        stringByReplacingOccurrencesOfString:@"%" withString:@"%25"]
+        stringByReplacingOccurrencesOfString:@"." withString:@"%2E"];
+    return [NSString stringWithFormat:@"%@.%@", keyPath, component];
+}
+
++ (NSString *)p_keyFromKeyPathComponent:(NSString *)component {
+    return [component stringByRemovingPercentEncoding];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,68 @@
+//
+//  POSStreamingFileValueStore.h
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSFileValueStore.h"
+
+@protocol POSByteSink;
+@protocol POSByteSource;
+
+NS_ASSUME_NONNULL_BEGIN
+
+///
+/// File value store which serializes value without building the whole archive in memory.
+///
+/// @discussion Dictionary values are written as a sequence of frames, one frame per top-level key.
+///             Each frame is archived separately and goes to the temporary file through the bounded
+///             buffer, which atomically replaces the destination file after the last frame. Loading
+///             decodes frames one by one from the file stream. So peak memory consumption is close to
+///             the size of the objects' graph plus the largest top-level entry archive. Other values
+///             are written as a single frame. Files in the format of POSFileValueStore are loaded as well.
+///             Every frame is compressed separately according to the compression settings of the store,
+///             so the threshold applies to the archive of the single entry.
+///
+/// @remarks    Only keys of the top-level dictionary are split into frames. Other values, including large
+///             arrays and nested containers, are archived as a single frame, so the whole archive of such
+///             value or entry is kept in memory while it is written or read.
+///
+///             Top-level entries are archived independently, so an object which is shared by several
+///             entries is loaded as separate copies, one per entry. POSFileValueStore preserves such
+///             sharing because it archives the whole graph at once.
+///
+@interface POSStreamingFileValueStore : POSFileValueStore
+
+///
+/// The designated initializer.
+/// @param filePath   Path to the file with serialized value.
+/// @param bufferSize The size of the buffers for reading and writing the file.
+///
+- (instancetype)initWithFilePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize;
+
+/// The size of the buffers for reading and writing the file.
+@property (nonatomic, readonly) NSUInteger bufferSize;
+
+#pragma mark Subclassing
+
+///
+/// @brief      Writes frames of the value including the terminating frame into the sink.
+///
+/// @remarks    Subclasses which transform the stream use it together with readValueFromSource:.
+///
+- (BOOL)writeValue:(POSLensValue<NSCoding> *)value toSink:(id<POSByteSink>)sink error:(NSError **)error;
+
+///
+/// @brief      Reads frames until the terminating frame and decodes the value from them.
+///
+/// @param maxFrameLength Upper bound for the length of a single frame. Larger lengths are treated as corruption.
+///
+- (nullable POSLensValue<NSCoding> *)readValueFromSource:(id<POSByteSource>)source
+                                          maxFrameLength:(unsigned long long)maxFrameLength
+                                                   error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,213 @@
+//
+//  POSStreamingFileValueStore.m
+//  POSLens
+//
+//  Created by Pavel Osipov on 19/10/2026.
+//  Copyright © 2026 Pavel Osipov. All rights reserved.
+//
+
+#import "POSStreamingFileValueStore.h"
+#import "POSFileIO.h"
+#import "POSKeyedArchiving.h"
+#import "NSError+POSLens.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static const uint8_t kPOSStreamMagic[8] = {'P', 'O', 'S', 'L', 'S', 'T', 'M', 1};
+
+typedef NS_ENUM(uint8_t, POSStreamFrameType) {
+    POSStreamFrameTypeEnd = 0,
+    POSStreamFrameTypeRoot = 1,
+    POSStreamFrameTypeEntry = 2
+};
+
+@implementation POSStreamingFileValueStore
+
+- (instancetype)initWithFilePath:(NSString *)filePath {
+    return [self initWithFilePath:filePath bufferSize:POSFileIODefaultBufferSize];
+}
+
+- (instancetype)initWithFilePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize {
+    POS_CHECK(bufferSize > 0);
+    if (self = [super initWithFilePath:filePath]) {
+        _bufferSize = bufferSize;
+    }
+    return self;
+}
+
+#pragma mark - POSValueStore
+
+- (BOOL)saveValue:(nullable POSLensValue<NSCoding> *)value error:(NSError **)error {
+    if (value == nil) {
+        return [self removeData:error];
+    }
+    POSAtomicFileWriter *writer = [[POSAtomicFileWriter alloc] initWithFilePath:self.filePath bufferSize:_bufferSize];
+    if (![writer open:error]) {
+        return NO;
+    }
+    @try {
+        if (![writer writeBytes:kPOSStreamMagic length:sizeof(kPOSStreamMagic) error:error] ||
+            ![self writeValue:value toSink:writer error:error]) {
+            [writer abort];
+            return NO;
+        }
+        return [writer commit:error];
+    } @catch (NSException *exception) {
+        [writer abort];
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        return NO;
+    }
+}
+
+- (nullable POSLensValue<NSCoding> *)loadValue:(NSError **)error {
+    if (![[NSFileManager defaultManager] fileExistsAtPath:self.filePath]) {
+        return nil;
+    }
+    POSFileReader *reader = [[POSFileReader alloc] initWithFilePath:self.filePath bufferSize:_bufferSize];
+    if (![reader open:error]) {
+        return nil;
+    }
+    uint8_t magic[sizeof(kPOSStreamMagic)];
+    if (reader.fileSize < sizeof(magic) ||
+        ![reader readBytes:magic length:sizeof(magic) error:nil] ||
+        memcmp(magic, kPOSStreamMagic, sizeof(magic)) != 0) {
+        [reader close];
+        return [super loadValue:error];
+    }
+    @try {
+        POSLensValue<NSCoding> *value = [self readValueFromSource:reader
+                                                   maxFrameLength:reader.fileSize
+                                                            error:error];
+        if (!value) {
+            return nil;
+        }
+        POS_CHECK([value conformsToProtocol:@protocol(POSLensPolicy)]);
+        POS_CHECK([value conformsToProtocol:@protocol(NSCopying)]);
+        return value;
+    } @catch (NSException *exception) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:exception.reason]);
+        return nil;
+    }
+}
+
+#pragma mark - Subclassing
+
+- (BOOL)writeValue:(POSLensValue<NSCoding> *)value toSink:(id<POSByteSink>)sink error:(NSError **)error {
+    uint8_t end = POSStreamFrameTypeEnd;
+    return ([self p_writeFramesOfValue:value toSink:sink error:error] &&
+            [sink writeBytes:&end length:sizeof(end) error:error]);
+}
+
+- (nullable POSLensValue<NSCoding> *)readValueFromSource:(id<POSByteSource>)source
+                                          maxFrameLength:(unsigned long long)maxFrameLength
+                                                   error:(NSError **)error {
+    NSMutableDictionary *entries = nil;
+    id rootValue = nil;
+    NSError *frameError = nil;
+    while (YES) {
+        @autoreleasepool {
+            uint8_t type;
+            if (![source readBytes:&type length:sizeof(type) error:&frameError]) {
+                break;
+            }
+            if (type == POSStreamFrameTypeEnd) {
+                break;
+            }
+            if (type == POSStreamFrameTypeRoot && entries == nil && rootValue == nil) {
+                NSData *data = [self p_readFrameDataFromSource:source maxLength:maxFrameLength error:&frameError];
+                rootValue = data ? POSUnarchiveObject(data) : nil;
+                if (!rootValue) {
+                    break;
+                }
+                continue;
+            }
+            if (type != POSStreamFrameTypeEntry || rootValue != nil) {
+                frameError = [NSError pos_systemErrorWithFormat:@"Unexpected frame %@ in %@", @(type), self.filePath];
+                break;
+            }
+            uint32_t keyLength;
+            if (![source readBytes:&keyLength length:sizeof(keyLength) error:&frameError]) {
+                break;
+            }
+            keyLength = CFSwapInt32LittleToHost(keyLength);
+            if (keyLength > maxFrameLength) {
+                frameError = [NSError pos_systemErrorWithFormat:@"Corrupted key in %@", self.filePath];
+                break;
+            }
+            NSData *keyData = [source readDataOfLength:keyLength error:&frameError];
+            NSData *data = keyData ? [self p_readFrameDataFromSource:source maxLength:maxFrameLength error:&frameError] : nil;
+            if (!data) {
+                break;
+            }
+            NSString *key = [[NSString alloc] initWithData:keyData encoding:NSUTF8StringEncoding];
+            id object = POSUnarchiveObject(data);
+            if (key == nil || object == nil) {
+                frameError = [NSError pos_systemErrorWithFormat:@"Corrupted entry in %@", self.filePath];
+                break;
+            }
+            if (!entries) {
+                entries = [NSMutableDictionary new];
+            }
+            entries[key] = object;
+        }
+    }
+    if (frameError) {
+        POSAssignError(error, frameError);
+        return nil;
+    }
+    return rootValue ?: [entries copy] ?: @{};
+}
+
+#pragma mark - Private
+
+- (BOOL)p_writeFramesOfValue:(POSLensValue<NSCoding> *)value
+                      toSink:(id<POSByteSink>)sink
+                       error:(NSError **)error {
+    if (!POSIsStringKeyedDictionary(value)) {
+        uint8_t type = POSStreamFrameTypeRoot;
+        NSData *data = [self compressData:POSArchiveObject(value)];
+        uint64_t dataLength = CFSwapInt64HostToLittle(data.length);
+        return ([sink writeBytes:&type length:sizeof(type) error:error] &&
+                [sink writeBytes:&dataLength length:sizeof(dataLength) error:error] &&
+                [sink writeData:data error:error]);
+    }
+    NSError *frameError = nil;
+    for (NSString *key in (NSDictionary *)value) {
+        @autoreleasepool {
+            uint8_t type = POSStreamFrameTypeEntry;
+            NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+            uint32_t keyLength = CFSwapInt32HostToLittle((uint32_t)keyData.length);
+            NSData *data = [self compressData:POSArchiveObject(((NSDictionary *)value)[key])];
+            uint64_t dataLength = CFSwapInt64HostToLittle(data.length);
+            if (![sink writeBytes:&type length:sizeof(type) error:&frameError] ||
+                ![sink writeBytes:&keyLength length:sizeof(keyLength) error:&frameError] ||
+                ![sink writeData:keyData error:&frameError] ||
+                ![sink writeBytes:&dataLength length:sizeof(dataLength) error:&frameError] ||
+                ![sink writeData:data error:&frameError]) {
+                break;
+            }
+        }
+    }
+    POSAssignError(error, frameError);
+    return frameError == nil;
+}
+
+- (nullable NSData *)p_readFrameDataFromSource:(id<POSByteSource>)source
+                                     maxLength:(unsigned long long)maxLength
+                                         error:(NSError **)error {
+    uint64_t dataLength;
+    if (![source readBytes:&dataLength length:sizeof(dataLength) error:error]) {
+        return nil;
+    }
+    dataLength = CFSwapInt64LittleToHost(dataLength);
+    if (dataLength > maxLength) {
+        POSAssignError(error, [NSError pos_systemErrorWithFormat:@"Corrupted frame in %@", self.filePath]);
+        return nil;
+    }
+    NSData *data = [source readDataOfLength:(NSUInteger)dataLength error:error];
+    return data ? [self decompressData:data error:error] : nil;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
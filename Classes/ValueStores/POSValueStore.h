@@ -38,4 +38,26 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+///
+/// Represents storage which loads and saves parts of the value independently.
+/// Key paths are dot separated keys of nested dictionaries. Empty string means the root value.
+///
+@protocol POSKeyPathValueStore <POSValueStore>
+
+///
+/// @brief      Loads the part of the value at specified keypath.
+/// @discussion Nil as return value means either missing value or an error which is returned
+///             in the out parameter.
+///
+- (nullable id)loadValueAtKeyPath:(NSString *)keyPath error:(NSError **)error;
+
+///
+/// @brief      Replaces the part of the value at specified keypath.
+/// @discussion Missing parent dictionaries are created. The store removes the part if the value is nil.
+/// @return     YES if the store has persisted value successfully.
+///
+- (BOOL)saveValue:(nullable id)value atKeyPath:(NSString *)keyPath error:(NSError **)error;
+
+@end
+
 NS_ASSUME_NONNULL_END
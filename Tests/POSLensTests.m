@@ -9,9 +9,20 @@
 #import "POSPersonSettings.h"
 #import "POSPersonSettingsStore.h"
 #import <POSLens/POSLens.h>
+#import <POSLens/POSEncryptedFileValueStore.h>
 #import <POSLens/POSEphemeralValueStore.h>
+#import <POSLens/POSLensGroup.h>
+#import <POSLens/POSLensChange.h>
+#import <POSLens/POSLensPublisher.h>
+#import <POSLens/POSLensReplica.h>
+#import <POSLens/POSLensReplicationConnection.h>
+#import <POSLens/POSLensValueInterner.h>
+#import <POSLens/POSSQLiteValueStore.h>
+#import <POSLens/POSStreamingFileValueStore.h>
 #import <POSErrorHandling/POSErrorHandling.h>
 #import <XCTest/XCTest.h>
+#import <sqlite3.h>
+#import <sys/socket.h>
 
 @interface POSMockLogger : NSObject <POSLogger>
 @property (nonatomic) NSString *lastLogString;
@@ -34,6 +45,29 @@
 
 @end
 
+@interface POSBlockingValueStore : POSEphemeralValueStore
+@property (nonatomic, readonly) dispatch_semaphore_t savingSemaphore;
+@property (nonatomic, readonly) dispatch_semaphore_t resumingSemaphore;
+@end
+
+@implementation POSBlockingValueStore
+
+- (instancetype)initWithValue:(nullable POSLensValue *)value {
+    if (self = [super initWithValue:value]) {
+        _savingSemaphore = dispatch_semaphore_create(0);
+        _resumingSemaphore = dispatch_semaphore_create(0);
+    }
+    return self;
+}
+
+- (BOOL)saveValue:(nullable POSLensValue *)value error:(NSError **)error {
+    dispatch_semaphore_signal(_savingSemaphore);
+    dispatch_semaphore_wait(_resumingSemaphore, DISPATCH_TIME_FOREVER);
+    return [super saveValue:value error:error];
+}
+
+@end
+
 @interface POSLensTests : XCTestCase
 @end
 
@@ -590,4 +624,707 @@
     [self waitForExpectationsWithTimeout:1 handler:nil];
 }
 
+- (void)testSQLiteValueStore {
+    NSString *databasePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    POSMutableLens<NSDictionary *> *settings = [POSMutableLens
+                                                lensWithDefaultValue:nil
+                                                store:[[POSSQLiteValueStore alloc] initWithFilePath:databasePath]
+                                                logger:nil
+                                                error:nil];
+    XCTAssertNotNil(settings);
+    XCTAssertNil(settings.value);
+    sqlite3 *db = NULL;
+    XCTAssertEqual(sqlite3_open(databasePath.fileSystemRepresentation, &db), SQLITE_OK);
+    XCTAssertEqual(sqlite3_exec(db,
+        "CREATE TABLE row_writes (count INTEGER NOT NULL);"
+        "INSERT INTO row_writes VALUES (0);"
+        "CREATE TRIGGER count_inserts AFTER INSERT ON pos_lens_values "
+        "BEGIN UPDATE row_writes SET count = count + 1; END;"
+        "CREATE TRIGGER count_deletes AFTER DELETE ON pos_lens_values "
+        "BEGIN UPDATE row_writes SET count = count + 1; END;",
+        NULL, NULL, NULL), SQLITE_OK);
+    sqlite3_stmt *statement = NULL;
+    XCTAssertEqual(sqlite3_prepare_v2(db, "SELECT count FROM row_writes", -1, &statement, NULL), SQLITE_OK);
+    NSError *error;
+    BOOL updated = [settings updateValue:
+        @{@"pavel": @{@"name": @"Pavel",
+                      @"age": @10,
+                      @"privacySettings":[[POSPersonPrivacySettings alloc]
+                                          initWithEmail:@"pavel@mail.ru"
+                                          password:@"123"]},
+          @"andrey": @{@"name": @"Andrey", @"age": @20}}
+        error:&error];
+    XCTAssertTrue(updated);
+    XCTAssertNil(error);
+    XCTAssertEqual(sqlite3_step(statement), SQLITE_ROW);
+    int rowWrites = sqlite3_column_int(statement, 0);
+    sqlite3_reset(statement);
+    updated = [settings[@"pavel"][@"name"] updateValue:@"Pavel Osipov" error:&error];
+    XCTAssertTrue(updated);
+    XCTAssertEqual(sqlite3_step(statement), SQLITE_ROW);
+    XCTAssertEqual(sqlite3_column_int(statement, 0), rowWrites + 1);
+    sqlite3_finalize(statement);
+    sqlite3_close(db);
+    updated = [settings[@"andrey"] removeValue:&error];
+    XCTAssertTrue(updated);
+    updated = [settings[@"user@example.co.uk"] updateValue:@{@"name": @"Example"} error:&error];
+    XCTAssertTrue(updated);
+    POSSQLiteValueStore *anotherStore = [[POSSQLiteValueStore alloc] initWithFilePath:databasePath];
+    NSDictionary *loadedSettings = [anotherStore loadValue:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(loadedSettings, settings.value);
+    XCTAssertNil(loadedSettings[@"andrey"]);
+    XCTAssertEqualObjects(loadedSettings[@"pavel"][@"name"], @"Pavel Osipov");
+    XCTAssertEqualObjects(loadedSettings[@"user@example.co.uk"][@"name"], @"Example");
+    XCTAssertEqualObjects([anotherStore loadValueAtKeyPath:@"pavel.age" error:&error], @10);
+    POSPersonPrivacySettings *privacySettings = [anotherStore
+                                                 loadValueAtKeyPath:@"pavel.privacySettings"
+                                                 error:&error];
+    XCTAssertEqualObjects(privacySettings.email, @"pavel@mail.ru");
+    XCTAssertNil([anotherStore loadValueAtKeyPath:@"andrey" error:&error]);
+    BOOL removed = [settings removeValue:&error];
+    XCTAssertTrue(removed);
+    XCTAssertNil([anotherStore loadValue:&error]);
+    XCTAssertNil(error);
+}
+
+- (void)testSQLiteValueStoreRewritesValueChangedByAnotherConnection {
+    NSString *databasePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    POSSQLiteValueStore *store = [[POSSQLiteValueStore alloc] initWithFilePath:databasePath];
+    POSSQLiteValueStore *anotherStore = [[POSSQLiteValueStore alloc] initWithFilePath:databasePath];
+    NSDictionary *andrey = @{@"name": @"Andrey", @"age": @20};
+    NSDictionary *value = @{@"pavel": @{@"name": @"Pavel"}, @"andrey": andrey};
+    NSError *error;
+    XCTAssertTrue([store saveValue:value error:&error]);
+    XCTAssertTrue([anotherStore saveValue:@{@"andrey": @{@"name": @"Andrey", @"age": @30}} error:&error]);
+    NSDictionary *newValue = @{@"pavel": @{@"name": @"Pavel Osipov"}, @"andrey": andrey};
+    XCTAssertTrue([store saveValue:newValue error:&error]);
+    XCTAssertEqualObjects([anotherStore loadValue:&error], newValue);
+    XCTAssertNil(error);
+}
+
+- (void)testSQLiteValueStoreKeyPathLens {
+    NSString *databasePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    POSSQLiteValueStore *store = [[POSSQLiteValueStore alloc] initWithFilePath:databasePath];
+    NSError *error;
+    XCTAssertTrue([store saveValue:@{@"pavel": @{@"name": @"Pavel", @"age": @10},
+                                     @"andrey": @{@"name": @"Andrey"}}
+                             error:&error]);
+    POSMutableLens<NSDictionary *> *pavel = [POSMutableLens
+                                             lensWithDefaultValue:nil
+                                             store:store
+                                             keyPath:@"pavel"
+                                             logger:nil
+                                             error:&error];
+    XCTAssertEqualObjects(pavel.value, (@{@"name": @"Pavel", @"age": @10}));
+    XCTAssertTrue([pavel[@"age"] updateValue:@11 error:&error]);
+    POSMutableLens<NSDictionary *> *oleg = [POSMutableLens
+                                            lensWithDefaultValue:nil
+                                            store:store
+                                            keyPath:@"users.oleg"
+                                            logger:nil
+                                            error:&error];
+    XCTAssertNil(oleg.value);
+    XCTAssertTrue([oleg updateValue:@{@"name": @"Oleg"} error:&error]);
+    POSSQLiteValueStore *anotherStore = [[POSSQLiteValueStore alloc] initWithFilePath:databasePath];
+    XCTAssertEqualObjects([anotherStore loadValue:&error],
+                          (@{@"pavel": @{@"name": @"Pavel", @"age": @11},
+                             @"andrey": @{@"name": @"Andrey"},
+                             @"users": @{@"oleg": @{@"name": @"Oleg"}}}));
+    XCTAssertNil(error);
+}
+
+- (void)testStreamingFileValueStore {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    POSPersonSettings *personSettings =
+    [[POSPersonSettings alloc]
+     initWithName:@"Pavel"
+     age:10
+     privacySettings:
+     [[POSPersonPrivacySettings alloc]
+      initWithEmail:@"pavel@mail.ru"
+      password:@"123"]];
+    NSError *error;
+    BOOL saved = [[[POSFileValueStore alloc] initWithFilePath:filePath] saveValue:personSettings error:&error];
+    XCTAssertTrue(saved);
+    POSStreamingFileValueStore *store = [[POSStreamingFileValueStore alloc] initWithFilePath:filePath bufferSize:16];
+    XCTAssertEqualObjects([store loadValue:&error], personSettings);
+    XCTAssertNil(error);
+    XCTAssertTrue([NSFileManager.defaultManager setAttributes:@{NSFilePosixPermissions: @0644}
+                                                 ofItemAtPath:filePath
+                                                        error:nil]);
+    saved = [store saveValue:personSettings error:&error];
+    XCTAssertTrue(saved);
+    XCTAssertEqualObjects([store loadValue:&error], personSettings);
+    NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:filePath
+                                                                                                     error:nil];
+    XCTAssertEqual(attributes.filePosixPermissions, 0644);
+    NSDictionary *settings = @{@"pavel": personSettings,
+                               @"andrey": @{@"name": @"Andrey", @"age": @20},
+                               @"counter": @10};
+    saved = [store saveValue:settings error:&error];
+    XCTAssertTrue(saved);
+    XCTAssertEqualObjects([store loadValue:&error], settings);
+    XCTAssertNil(error);
+    NSDictionary *redundantSettings = [self p_makeRedundantSettingsWithCount:100];
+    saved = [store saveValue:@{@"settings": redundantSettings} error:&error];
+    XCTAssertTrue(saved);
+    unsigned long long uncompressedSize = [self p_fileSizeAtPath:filePath];
+    store.compression = POSValueCompressionLZ4;
+    saved = [store saveValue:@{@"settings": redundantSettings} error:&error];
+    XCTAssertTrue(saved);
+    XCTAssertLessThan([self p_fileSizeAtPath:filePath], uncompressedSize);
+    XCTAssertEqualObjects([store loadValue:&error], @{@"settings": redundantSettings});
+    XCTAssertNil(error);
+    saved = [store saveValue:@{} error:&error];
+    XCTAssertTrue(saved);
+    XCTAssertEqualObjects([store loadValue:&error], @{});
+    saved = [store saveValue:nil error:&error];
+    XCTAssertTrue(saved);
+    XCTAssertNil([store loadValue:&error]);
+    XCTAssertNil(error);
+}
+
+- (void)testCompressedFileValueStore {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    POSFileValueStore *store = [[POSFileValueStore alloc] initWithFilePath:filePath];
+    store.compression = POSValueCompressionLZ4;
+    NSError *error;
+    BOOL saved = [store saveValue:@{@"name": @"Pavel"} error:&error];
+    XCTAssertTrue(saved);
+    NSData *rawData = [NSData dataWithContentsOfFile:filePath];
+    XCTAssertEqualObjects([rawData subdataWithRange:NSMakeRange(0, 6)], [@"bplist" dataUsingEncoding:NSASCIIStringEncoding]);
+    NSDictionary *settings = [self p_makeRedundantSettingsWithCount:100];
+    saved = [store saveValue:settings error:&error];
+    XCTAssertTrue(saved);
+    NSData *compressedData = [NSData dataWithContentsOfFile:filePath];
+    XCTAssertEqualObjects([compressedData subdataWithRange:NSMakeRange(0, 4)], [@"POSZ" dataUsingEncoding:NSASCIIStringEncoding]);
+    XCTAssertEqualObjects([store loadValue:&error], settings);
+    XCTAssertNil(error);
+    POSFileValueStore *uncompressedStore = [[POSFileValueStore alloc] initWithFilePath:filePath];
+    XCTAssertEqualObjects([uncompressedStore loadValue:&error], settings);
+    XCTAssertNil(error);
+    saved = [uncompressedStore saveValue:settings error:&error];
+    XCTAssertTrue(saved);
+    NSData *uncompressedData = [NSData dataWithContentsOfFile:filePath];
+    XCTAssertLessThan(compressedData.length, uncompressedData.length);
+    XCTAssertEqualObjects([store loadValue:&error], settings);
+}
+
+- (void)testUncompressedFileValueStoreSavePerformance {
+    [self p_measureFileValueStoreWithCompression:POSValueCompressionNone load:NO];
+}
+
+- (void)testCompressedFileValueStoreSavePerformance {
+    [self p_measureFileValueStoreWithCompression:POSValueCompressionLZ4 load:NO];
+}
+
+- (void)testUncompressedFileValueStoreLoadPerformance {
+    [self p_measureFileValueStoreWithCompression:POSValueCompressionNone load:YES];
+}
+
+- (void)testCompressedFileValueStoreLoadPerformance {
+    [self p_measureFileValueStoreWithCompression:POSValueCompressionLZ4 load:YES];
+}
+
+- (void)testStreamingFileValueStoreSavePerformance {
+    [self p_measureStreamingFileValueStoreWithEncryption:NO load:NO];
+}
+
+- (void)testEncryptedFileValueStoreSavePerformance {
+    [self p_measureStreamingFileValueStoreWithEncryption:YES load:NO];
+}
+
+- (void)testStreamingFileValueStoreLoadPerformance {
+    [self p_measureStreamingFileValueStoreWithEncryption:NO load:YES];
+}
+
+- (void)testEncryptedFileValueStoreLoadPerformance {
+    [self p_measureStreamingFileValueStoreWithEncryption:YES load:YES];
+}
+
+- (void)testLensGroupUpdate {
+    NSString *journalPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    POSLensGroupJournal *journal = [[POSLensGroupJournal alloc] initWithPath:journalPath];
+    POSMutableLens<NSDictionary *> *accounts = [POSMutableLens
+                                                lensWithDefaultValue:nil
+                                                store:[journal
+                                                       storeWithStore:[[POSEphemeralValueStore alloc]
+                                                                       initWithValue:@{@"pavel": @10}]
+                                                       identifier:@"accounts"]
+                                                logger:nil
+                                                error:nil];
+    POSMutableLens<NSDictionary *> *history = [POSMutableLens
+                                               lensWithDefaultValue:@{}
+                                               store:[journal
+                                                      storeWithStore:[[POSEphemeralValueStore alloc] initWithValue:nil]
+                                                      identifier:@"history"]
+                                               logger:nil
+                                               error:nil];
+    POSLensGroup *group = [POSLensGroup groupWithLenses:@[accounts[@"pavel"], history, accounts]
+                                                journal:journal
+                                                 logger:nil];
+    XCTAssertNotNil(group);
+    NSMutableArray<NSDictionary *> *accountsValues = [NSMutableArray new];
+    [accounts.valueUpdates subscribeNext:^(NSDictionary *value) {
+        [accountsValues addObject:value];
+    }];
+    NSError *error;
+    BOOL updated = [group updateWithBlock:^BOOL(POSLensTransaction *transaction, NSError **error) {
+        NSNumber *balance = [transaction valueForLens:accounts[@"pavel"]];
+        return ([transaction updateLens:accounts[@"pavel"] value:@(balance.integerValue - 3) error:error] &&
+                [transaction updateLens:history[@"pavel"] value:@[@(-3)] error:error]);
+    } error:&error];
+    XCTAssertTrue(updated);
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(accounts.value, @{@"pavel": @7});
+    XCTAssertEqualObjects(history.value, @{@"pavel": @[@(-3)]});
+    XCTAssertEqual(accountsValues.count, 2);
+    XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:journalPath]);
+    updated = [group updateWithBlock:^BOOL(POSLensTransaction *transaction, NSError **error) {
+        [transaction updateLens:accounts[@"pavel"] value:@0 error:error];
+        return NO;
+    } error:&error];
+    XCTAssertFalse(updated);
+    XCTAssertEqualObjects(accounts.value, @{@"pavel": @7});
+    XCTAssertEqual(accountsValues.count, 2);
+}
+
+- (void)testLensGroupRollback {
+    id<POSValueStore> accountsStore = [[POSEphemeralValueStore alloc] initWithValue:@{@"pavel": @10}];
+    POSMutableLens<NSDictionary *> *accounts = [POSMutableLens
+                                                lensWithDefaultValue:nil
+                                                store:accountsStore
+                                                logger:nil
+                                                error:nil];
+    POSMutableLens<POSPersonSettings *> *settings = [POSMutableLens
+                                                     lensWithDefaultValue:nil
+                                                     store:[[POSPersonSettingsStore alloc]
+                                                            initWithSettings:
+                                                            [[POSPersonSettings alloc]
+                                                             initWithName:@"Pavel"
+                                                             age:10
+                                                             privacySettings:nil]]
+                                                     logger:nil
+                                                     error:nil];
+    POSLensGroup *group = [POSLensGroup groupWithLenses:@[accounts, settings]
+                                                journal:nil
+                                                 logger:nil];
+    NSError *error;
+    BOOL updated = [group updateWithBlock:^BOOL(POSLensTransaction *transaction, NSError **error) {
+        return ([transaction updateLens:accounts[@"pavel"] value:@7 error:error] &&
+                [transaction updateLens:settings[@"name"] value:@"Pavel Osipov" error:error]);
+    } error:&error];
+    XCTAssertFalse(updated);
+    XCTAssertEqualObjects(error.domain, kPOSErrorDomain);
+    XCTAssertEqualObjects(accounts.value, @{@"pavel": @10});
+    XCTAssertEqualObjects([accountsStore loadValue:nil], @{@"pavel": @10});
+    XCTAssertEqualObjects(settings.value.name, @"Pavel");
+}
+
+- (void)testLensGroupJournalReplay {
+    NSString *journalPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    NSData *journalData = [NSKeyedArchiver archivedDataWithRootObject:@{@"accounts": @{@"pavel": @7},
+                                                                        @"history": @{@"pavel": @[@(-3)]}}];
+    XCTAssertTrue([journalData writeToFile:journalPath atomically:YES]);
+    POSLensGroupJournal *journal = [[POSLensGroupJournal alloc] initWithPath:journalPath];
+    id<POSValueStore> historyStore = [[POSEphemeralValueStore alloc] initWithValue:nil];
+    NSError *error;
+    POSMutableLens<NSDictionary *> *history = [POSMutableLens
+                                               lensWithDefaultValue:@{}
+                                               store:[journal storeWithStore:historyStore identifier:@"history"]
+                                               logger:nil
+                                               error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(history.value, @{@"pavel": @[@(-3)]});
+    XCTAssertEqualObjects([historyStore loadValue:nil], @{@"pavel": @[@(-3)]});
+    XCTAssertTrue([NSFileManager.defaultManager fileExistsAtPath:journalPath]);
+    POSMutableLens<NSDictionary *> *accounts = [POSMutableLens
+                                                lensWithDefaultValue:@{}
+                                                store:[journal
+                                                       storeWithStore:[[POSEphemeralValueStore alloc]
+                                                                       initWithValue:@{@"pavel": @10}]
+                                                       identifier:@"accounts"]
+                                                logger:nil
+                                                error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(accounts.value, @{@"pavel": @7});
+    XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:journalPath]);
+}
+
+- (void)testLensChangesComputationAndApplying {
+    POSPersonPrivacySettings *privacySettings = [[POSPersonPrivacySettings alloc]
+                                                 initWithEmail:@"pavel@mail.ru"
+                                                 password:@"123"];
+    NSDictionary *andreySettings = @{@"name": @"Andrey", @"age": @20};
+    NSDictionary *oldValue = @{@"pavel": @{@"name": @"Pavel", @"age": @10, @"privacySettings": privacySettings},
+                               @"andrey": andreySettings};
+    NSDictionary *newValue = @{@"pavel": @{@"name": @"Pavel Osipov",
+                                           @"privacySettings": [privacySettings
+                                                                pos_setValue:@"321"
+                                                                forKey:@"password"]},
+                               @"andrey": andreySettings,
+                               @"user@example.co.uk": @{@"name": @"Example"}};
+    NSArray<POSLensChange *> *changes = [POSLensChange changesFromValue:oldValue toValue:newValue];
+    XCTAssertEqual(changes.count, 4);
+    XCTAssertTrue([changes containsObject:[[POSLensChange alloc]
+                                           initWithType:POSLensChangeTypeRemove
+                                           keys:@[@"pavel", @"age"]
+                                           value:nil]]);
+    XCTAssertTrue([changes containsObject:[[POSLensChange alloc]
+                                           initWithType:POSLensChangeTypeSet
+                                           keys:@[@"user@example.co.uk"]
+                                           value:@{@"name": @"Example"}]]);
+    NSData *data = [NSKeyedArchiver archivedDataWithRootObject:changes];
+    NSArray<POSLensChange *> *decodedChanges = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+    XCTAssertEqualObjects(decodedChanges, changes);
+    NSError *error;
+    NSDictionary *appliedValue = [POSLensChange valueByApplyingChanges:decodedChanges toValue:oldValue error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(appliedValue, newValue);
+    XCTAssertTrue(appliedValue[@"andrey"] == andreySettings);
+    XCTAssertEqualObjects([POSLensChange changesFromValue:newValue toValue:nil],
+                          @[[[POSLensChange alloc] initWithType:POSLensChangeTypeRemove keys:@[] value:nil]]);
+    XCTAssertNil([POSLensChange valueByApplyingChanges:changes toValue:nil error:&error]);
+    XCTAssertNotNil(error);
+}
+
+- (void)testLensReplication {
+    NSString *socketPath = [NSString stringWithFormat:@"/tmp/poslens-%@.sock", @(getpid())];
+    POSMutableLens<NSDictionary *> *settings = [POSMutableLens lensWithValue:
+                                                @{@"pavel": @{@"name": @"Pavel", @"age": @10}}];
+    NSError *error;
+    POSLensPublisher *publisher = [POSLensPublisher
+                                   publisherWithLens:settings
+                                   socketPath:socketPath
+                                   logger:nil
+                                   error:&error];
+    XCTAssertNotNil(publisher);
+    XCTAssertNil(error);
+    POSLensReplica *replica = [POSLensReplica
+                               replicaWithSocketPath:socketPath
+                               defaultValue:nil
+                               logger:nil
+                               error:&error];
+    XCTAssertNotNil(replica);
+    XCTAssertNil(error);
+    XCTestExpectation *snapshotExpectation = [self expectationWithDescription:@"snapshot"];
+    XCTestExpectation *changesExpectation = [self expectationWithDescription:@"changes"];
+    [replica.lens.valueUpdates subscribeNext:^(NSDictionary *value) {
+        if ([value[@"pavel"][@"name"] isEqual:@"Pavel"]) {
+            [snapshotExpectation fulfill];
+        } else if ([value[@"pavel"][@"name"] isEqual:@"Pavel Osipov"] && value[@"andrey"] != nil) {
+            [changesExpectation fulfill];
+        }
+    }];
+    [self waitForExpectations:@[snapshotExpectation] timeout:5];
+    [settings[@"pavel"][@"name"] updateValue:@"Pavel Osipov" error:nil];
+    [settings[@"andrey"] updateValue:@{@"name": @"Andrey", @"age": @20} error:nil];
+    [self waitForExpectations:@[changesExpectation] timeout:5];
+    XCTAssertEqualObjects(replica.lens.value, settings.value);
+    [replica invalidate];
+    [publisher invalidate];
+}
+
+- (void)testLensReplicaResyncAfterGap {
+    NSString *socketPath = [NSString stringWithFormat:@"/tmp/poslens-resync-%@.sock", @(getpid())];
+    struct sockaddr_un address;
+    XCTAssertTrue(POSLensReplicationSocketAddress(socketPath, &address, nil));
+    unlink(address.sun_path);
+    int listeningSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    XCTAssertGreaterThanOrEqual(listeningSocket, 0);
+    XCTAssertEqual(bind(listeningSocket, (const struct sockaddr *)&address, sizeof(address)), 0);
+    XCTAssertEqual(listen(listeningSocket, 1), 0);
+    POSLensReplica *replica = [POSLensReplica
+                               replicaWithSocketPath:socketPath
+                               defaultValue:nil
+                               logger:nil
+                               error:nil];
+    XCTAssertNotNil(replica);
+    int followerSocket = accept(listeningSocket, NULL, NULL);
+    XCTAssertGreaterThanOrEqual(followerSocket, 0);
+    dispatch_queue_t queue = dispatch_queue_create("com.github.pavelosipov.POSLensTests.publisher", DISPATCH_QUEUE_SERIAL);
+    POSLensReplicationConnection *follower = [[POSLensReplicationConnection alloc]
+                                              initWithSocket:followerSocket
+                                              queue:queue
+                                              pendingBytesLimit:POSLensReplicationDefaultPendingBytesLimit];
+    follower.allowedMessageClasses = [NSSet setWithObjects:NSDictionary.class, NSString.class, NSNumber.class, nil];
+    XCTestExpectation *resyncExpectation = [self expectationWithDescription:@"resync"];
+    follower.messageHandler = ^(NSDictionary<NSString *, id> *message) {
+        if ([message[kPOSLensReplicationResyncKey] boolValue]) {
+            [resyncExpectation fulfill];
+        }
+    };
+    XCTestExpectation *snapshotExpectation = [self expectationWithDescription:@"snapshot"];
+    XCTestExpectation *freshSnapshotExpectation = [self expectationWithDescription:@"fresh snapshot"];
+    [replica.lens.valueUpdates subscribeNext:^(NSDictionary *value) {
+        if ([value[@"counter"] isEqual:@1]) {
+            [snapshotExpectation fulfill];
+        } else if ([value[@"counter"] isEqual:@3]) {
+            [freshSnapshotExpectation fulfill];
+        }
+    }];
+    __auto_type send = ^(NSDictionary<NSString *, id> *message) {
+        NSData *frame = [POSLensReplicationConnection frameWithMessage:message error:nil];
+        dispatch_async(queue, ^{ [follower sendFrame:frame force:YES]; });
+    };
+    dispatch_async(queue, ^{ [follower resume]; });
+    send(@{kPOSLensReplicationSequenceKey: @1, kPOSLensReplicationSnapshotKey: @{@"counter": @1}});
+    [self waitForExpectations:@[snapshotExpectation] timeout:5];
+    // Changes #2 were dropped, so #3 can't be applied.
+    send(@{kPOSLensReplicationSequenceKey: @3,
+           kPOSLensReplicationChangesKey: [POSLensChange changesFromValue:@{@"counter": @2}
+                                                                  toValue:@{@"counter": @3}]});
+    [self waitForExpectations:@[resyncExpectation] timeout:5];
+    XCTAssertEqualObjects(replica.lens.value, @{@"counter": @1});
+    send(@{kPOSLensReplicationSequenceKey: @3, kPOSLensReplicationSnapshotKey: @{@"counter": @3}});
+    [self waitForExpectations:@[freshSnapshotExpectation] timeout:5];
+    [replica invalidate];
+    dispatch_sync(queue, ^{ [follower close]; });
+    close(listeningSocket);
+    unlink(address.sun_path);
+}
+
+- (void)testValueInterning {
+    POSLensValueInterner *interner = [POSLensValueInterner new];
+    __auto_type makeAccount = ^NSDictionary *(NSString *name) {
+        return @{@"name": [name mutableCopy],
+                 @"flags": @[@YES, @1],
+                 @"privacySettings": [[POSPersonPrivacySettings alloc]
+                                      initWithEmail:[@"pavel@mail.ru" mutableCopy]
+                                      password:@"123"]};
+    };
+    POSMutableLens<NSDictionary *> *accounts = [POSMutableLens
+                                                lensWithDefaultValue:nil
+                                                store:[[POSEphemeralValueStore alloc] initWithValue:
+                                                       @{@"pavel": makeAccount(@"Pavel")}]
+                                                interner:interner
+                                                logger:nil
+                                                error:nil];
+    POSMutableLens<NSDictionary *> *otherAccounts = [POSMutableLens
+                                                     lensWithDefaultValue:nil
+                                                     store:[[POSEphemeralValueStore alloc] initWithValue:nil]
+                                                     interner:interner
+                                                     logger:nil
+                                                     error:nil];
+    [accounts[@"andrey"] updateValue:makeAccount(@"Pavel") error:nil];
+    [otherAccounts[@"pavel"] updateValue:makeAccount(@"Pavel") error:nil];
+    NSDictionary *pavelAccount = accounts.value[@"pavel"];
+    XCTAssertTrue(accounts.value[@"andrey"] == pavelAccount);
+    XCTAssertTrue(otherAccounts.value[@"pavel"] == pavelAccount);
+    XCTAssertEqual(strcmp([pavelAccount[@"flags"][0] objCType], [@YES objCType]), 0);
+    XCTAssertEqual(strcmp([pavelAccount[@"flags"][1] objCType], [@1 objCType]), 0);
+    [accounts[@"andrey"][@"privacySettings"] updateValue:[[POSPersonPrivacySettings alloc]
+                                                          initWithEmail:@"andrey@mail.ru"
+                                                          password:@"123"]
+                                                   error:nil];
+    XCTAssertTrue(accounts.value[@"andrey"][@"name"] == pavelAccount[@"name"]);
+    XCTAssertTrue(accounts.value[@"pavel"] == pavelAccount);
+    XCTAssertTrue([interner internValue:[makeAccount(@"Pavel") mutableCopy]] == pavelAccount);
+    XCTAssertNil([interner internValue:nil]);
+}
+
+- (void)testConcurrentValueInterning {
+    POSLensValueInterner *interner = [POSLensValueInterner new];
+    NSDictionary *canonicalValue = [interner internValue:@{@"name": [@"Pavel" mutableCopy], @"ids": @[@1, @2]}];
+    const size_t iterations = 64;
+    NSMutableArray *internedValues = [NSMutableArray new];
+    for (size_t i = 0; i < iterations; ++i) {
+        [internedValues addObject:[NSNull null]];
+    }
+    dispatch_queue_t resultsQueue = dispatch_queue_create("POSLensTests.interning", DISPATCH_QUEUE_SERIAL);
+    dispatch_apply(iterations, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        NSString *name = [NSString stringWithFormat:@"User %@", @(i % 8)];
+        id internedValue = [interner internValue:@{@"name": [name mutableCopy], @"ids": @[@1, @2]}];
+        dispatch_sync(resultsQueue, ^{
+            internedValues[i] = internedValue;
+        });
+    });
+    for (size_t i = 0; i < iterations; ++i) {
+        XCTAssertTrue(internedValues[i] == internedValues[i % 8]);
+        XCTAssertTrue(internedValues[i][@"ids"] == canonicalValue[@"ids"]);
+    }
+}
+
+- (void)testUpdateWaitMetrics {
+    POSMutableLens<NSDictionary *> *settings = [POSMutableLens lensWithValue:@{}];
+    POSLensUpdatePriority priority = POSLensUpdatePriorityUrgent;
+    XCTAssertEqual([settings waitMetricsForPriority:priority].count, 0);
+    XCTestExpectation *expectation = [self expectationWithDescription:@"urgent updates"];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [settings[@"pavel"] updateValue:@10 error:nil];
+        [settings[@"andrey"] forceUpdateValue:@20];
+        [expectation fulfill];
+    });
+    [self waitForExpectations:@[expectation] timeout:5];
+    POSLensWaitMetrics *metrics = [settings[@"pavel"] waitMetricsForPriority:priority];
+    XCTAssertEqual(metrics.priority, priority);
+    XCTAssertEqual(metrics.count, 2);
+    XCTAssertGreaterThanOrEqual(metrics.maxWaitTime, metrics.averageWaitTime);
+    XCTAssertGreaterThanOrEqual(metrics.totalWaitTime, metrics.maxWaitTime);
+}
+
+- (void)testBackgroundForceUpdatePersistence {
+    id<POSValueStore> store = [[POSEphemeralValueStore alloc] initWithValue:@{}];
+    POSMutableLens<NSDictionary *> *settings = [POSMutableLens
+                                                lensWithDefaultValue:nil
+                                                store:store
+                                                logger:nil
+                                                error:nil];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"background update"];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_BACKGROUND, 0), ^{
+        [settings[@"pavel"] forceUpdateValue:@10];
+        XCTAssertEqualObjects(settings.value, @{@"pavel": @10});
+        [expectation fulfill];
+    });
+    [self waitForExpectations:@[expectation] timeout:5];
+    XCTAssertEqual([settings waitMetricsForPriority:POSLensUpdatePriorityBackground].count, 1);
+    BOOL updated = [settings[@"andrey"] updateValue:@20 error:nil];
+    XCTAssertTrue(updated);
+    XCTAssertEqualObjects([store loadValue:nil], (@{@"pavel": @10, @"andrey": @20}));
+}
+
+- (void)testUrgentUpdateDuringBackgroundSave {
+    POSBlockingValueStore *store = [[POSBlockingValueStore alloc] initWithValue:@{}];
+    POSMutableLens<NSDictionary *> *settings = [POSMutableLens
+                                                lensWithDefaultValue:nil
+                                                store:store
+                                                logger:nil
+                                                error:nil];
+    NSMutableArray<NSString *> *events = [NSMutableArray new];
+    XCTestExpectation *backgroundExpectation = [self expectationWithDescription:@"background update"];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_BACKGROUND, 0), ^{
+        BOOL updated = [settings[@"pavel"] updateValue:@10 error:nil];
+        XCTAssertTrue(updated);
+        @synchronized (events) {
+            [events addObject:@"background"];
+        }
+        [backgroundExpectation fulfill];
+    });
+    dispatch_time_t timeout = dispatch_time(DISPATCH_TIME_NOW, 5 * NSEC_PER_SEC);
+    XCTAssertEqual(dispatch_semaphore_wait(store.savingSemaphore, timeout), 0);
+    XCTestExpectation *urgentExpectation = [self expectationWithDescription:@"urgent update"];
+    dispatch_semaphore_t urgentTurnSemaphore = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [settings updateValueWithBlock:^NSDictionary *(NSDictionary *value, NSError **error) {
+            XCTAssertEqualObjects(value, @{@"pavel": @10});
+            @synchronized (events) {
+                [events addObject:@"urgent"];
+            }
+            dispatch_semaphore_signal(urgentTurnSemaphore);
+            return [value pos_setValue:@20 forKey:@"andrey"];
+        } error:nil];
+        [urgentExpectation fulfill];
+    });
+    // The background save is still blocked, but the urgent update gets its turn.
+    XCTAssertEqual(dispatch_semaphore_wait(urgentTurnSemaphore, timeout), 0);
+    @synchronized (events) {
+        XCTAssertEqualObjects(events, @[@"urgent"]);
+    }
+    dispatch_semaphore_signal(store.resumingSemaphore);
+    dispatch_semaphore_signal(store.resumingSemaphore);
+    [self waitForExpectations:@[backgroundExpectation, urgentExpectation] timeout:5];
+    XCTAssertEqualObjects([store loadValue:nil], (@{@"pavel": @10, @"andrey": @20}));
+}
+
+- (void)testEncryptedFileValueStore {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    NSError *error;
+    NSData *key = [POSEncryptedFileValueStore generateKey:&error];
+    XCTAssertEqual(key.length, POSEncryptedFileValueStoreKeySize);
+    POSEncryptedFileValueStore *store = [[POSEncryptedFileValueStore alloc] initWithFilePath:filePath key:key chunkSize:16];
+    NSDictionary *settings = @{@"pavel": @{@"password": @"secret-password"},
+                               @"counter": @10};
+    BOOL saved = [store saveValue:settings error:&error];
+    XCTAssertTrue(saved);
+    NSData *rawData = [NSData dataWithContentsOfFile:filePath];
+    XCTAssertEqual([rawData rangeOfData:[@"secret-password" dataUsingEncoding:NSUTF8StringEncoding]
+                                options:0
+                                  range:NSMakeRange(0, rawData.length)].location, NSNotFound);
+    XCTAssertEqualObjects([store loadValue:&error], settings);
+    XCTAssertNil(error);
+    POSEncryptedFileValueStore *wrongKeyStore =
+        [[POSEncryptedFileValueStore alloc] initWithFilePath:filePath key:[POSEncryptedFileValueStore generateKey:nil]];
+    XCTAssertNil([wrongKeyStore loadValue:&error]);
+    XCTAssertNotNil(error);
+    error = nil;
+    [[rawData subdataWithRange:NSMakeRange(0, rawData.length - 1)] writeToFile:filePath atomically:YES];
+    XCTAssertNil([store loadValue:&error]);
+    XCTAssertNotNil(error);
+    error = nil;
+    NSMutableData *tamperedData = [rawData mutableCopy];
+    ((uint8_t *)tamperedData.mutableBytes)[tamperedData.length / 2] ^= 1;
+    [tamperedData writeToFile:filePath atomically:YES];
+    XCTAssertNil([store loadValue:&error]);
+    XCTAssertNotNil(error);
+    error = nil;
+    saved = [[[POSStreamingFileValueStore alloc] initWithFilePath:filePath] saveValue:settings error:&error];
+    XCTAssertTrue(saved);
+    XCTAssertNil([store loadValue:&error]);
+    XCTAssertNotNil(error);
+    error = nil;
+    saved = [store saveValue:nil error:&error];
+    XCTAssertTrue(saved);
+    XCTAssertNil([store loadValue:&error]);
+    XCTAssertNil(error);
+}
+
+#pragma mark - Private
+
+- (NSDictionary *)p_makeRedundantSettingsWithCount:(NSUInteger)count {
+    NSMutableDictionary *settings = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSString *email = [NSString stringWithFormat:@"user%@@mail.ru", @(i)];
+        settings[email] = [[POSPersonSettings alloc]
+                           initWithName:[NSString stringWithFormat:@"User %@", @(i)]
+                           age:(NSInteger)(i % 100)
+                           privacySettings:[[POSPersonPrivacySettings alloc] initWithEmail:email password:@"123"]];
+    }
+    return [settings copy];
+}
+
+- (void)p_measureFileValueStoreWithCompression:(POSValueCompression)compression load:(BOOL)load {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    POSFileValueStore *store = [[POSFileValueStore alloc] initWithFilePath:filePath];
+    NSDictionary *settings = [self p_makeRedundantSettingsWithCount:10000];
+    XCTAssertTrue([store saveValue:settings error:nil]);
+    unsigned long long uncompressedSize = [self p_fileSizeAtPath:filePath];
+    store.compression = compression;
+    XCTAssertTrue([store saveValue:settings error:nil]);
+    double sizeRatio = (double)[self p_fileSizeAtPath:filePath] / uncompressedSize;
+    [XCTContext runActivityNamed:[NSString stringWithFormat:@"On-disk size ratio: %.3f", sizeRatio]
+                           block:^(id<XCTActivity> activity) {}];
+    if (compression == POSValueCompressionNone) {
+        XCTAssertEqual(sizeRatio, 1.0);
+    } else {
+        XCTAssertLessThan(sizeRatio, 1.0);
+    }
+    [self p_measureValueStore:store value:settings load:load];
+    [NSFileManager.defaultManager removeItemAtPath:filePath error:nil];
+}
+
+- (void)p_measureValueStore:(id<POSValueStore>)store value:(POSLensValue *)value load:(BOOL)load {
+    XCTAssertTrue([store saveValue:value error:nil]);
+    [self measureBlock:^{
+        if (load) {
+            XCTAssertNotNil([store loadValue:nil]);
+        } else {
+            XCTAssertTrue([store saveValue:value error:nil]);
+        }
+    }];
+}
+
+- (void)p_measureStreamingFileValueStoreWithEncryption:(BOOL)encryption load:(BOOL)load {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    POSStreamingFileValueStore *store = (encryption
+        ? [[POSEncryptedFileValueStore alloc] initWithFilePath:filePath key:[POSEncryptedFileValueStore generateKey:nil]]
+        : [[POSStreamingFileValueStore alloc] initWithFilePath:filePath]);
+    [self p_measureValueStore:store value:[self p_makeRedundantSettingsWithCount:10000] load:load];
+    [NSFileManager.defaultManager removeItemAtPath:filePath error:nil];
+}
+
+- (unsigned long long)p_fileSizeAtPath:(NSString *)filePath {
+    return [[NSFileManager.defaultManager attributesOfItemAtPath:filePath error:nil] fileSize];
+}
+
 @end
@@ -7,10 +7,11 @@
 //
 
 #import <POSLens/POSLens.h>
+#import <POSLens/POSLensValueInterner.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface POSPersonPrivacySettings : NSObject <NSCopying, NSCoding>
+@interface POSPersonPrivacySettings : NSObject <NSCopying, NSCoding, POSLensInternableValue>
 
 @property (nonatomic, readonly, nullable) NSString *email;
 @property (nonatomic, readonly, nullable) NSString *password;
@@ -48,6 +48,10 @@ NS_ASSUME_NONNULL_BEGIN
     return POSObjectsAreEqual(_email, other.email) && POSObjectsAreEqual(_password, other.password);
 }
 
+- (NSUInteger)hash {
+    return _email.hash ^ _password.hash;
+}
+
 @end
 
 #pragma mark -